@@ -101,7 +101,9 @@ Level = {
         map_file = map_file_path,
         texture_asset_id = map_texture_asset_id,
         tile_size = 32,
-        scale = 2.0
+        scale = 2.0,
+        -- tile ids (row * 10 + column in the tileset) that block moving colliders
+        solid_tiles = {}
     },
 
     ----------------------------------------------------
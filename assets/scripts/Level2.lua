@@ -85,7 +85,9 @@ Level = {
         map_file = "./assets/tilemaps/desert.map",
         texture_asset_id = "tilemap-texture",
         tile_size = 32,
-        scale = 2.0
+        scale = 2.0,
+        -- tile ids (row * 10 + column in the tileset) that block moving colliders
+        solid_tiles = {}
     },
 
     ----------------------------------------------------
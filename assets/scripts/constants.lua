@@ -2,10 +2,28 @@
 config = {
     title = "My Game Engine",
     full_screen = false,
-    target_fps=60 ,
+    target_fps=60 , -- render rate cap, 0 renders as fast as possible
+    vsync = false, -- wait for the display refresh instead, target_fps is then ignored
+    simulation_rate = 60, -- fixed simulation steps per second, independent of the render rate
+    max_simulation_steps = 5, -- most steps run to catch up in one frame, the rest of the backlog is dropped
     debug = false,
     verbose_logging = false,
     debug_to_console = false,
+    headless = false, -- no window, audio or GUI, the simulation runs as fast as it can, same as --headless
+    headless_ticks = 0, -- stop a headless run after this many updates, 0 runs until interrupted, same as --ticks
+    record_input = "", -- write key presses and per tick state hashes to this file, same as --record
+    replay_input = "", -- play back a recording instead of live keys, same as --replay
+    trace_file = "trace.json", -- where profiler captures are written, open it in chrome://tracing or ui.perfetto.dev
+    trace_frames = 300, -- frames per capture, F9 starts one
+    trace_at_frame = -1, -- start a capture at this frame, 0 is the level load, -1 only on F9, same as --trace
+    allocation_report = "allocations.txt", -- per scope allocation counts, written on F10 and on exit in builds with allocation tracking
+    random_seed = 1, -- Lua math.random seed of recorded runs, a replay uses the recording's, same as --seed
+    collision_stay_interval = 0, -- frames between CollisionStay events, 0 disables them
+    worker_threads = -1, -- extra threads for parallel systems, -1 uses every spare core
+    text_cache_budget_kb = 4096, -- memory for cached text textures, least recently used labels go first
+    fog_cell_size = 32, -- world pixels per fog of war cell
+    radar_refresh_rate = 10, -- radar redraws per second, 0 redraws every frame
+    debug_font = "pico8-font-10", -- font of the debug overlay's text, must be loaded by the level
     resolution = {
         window_width = 1280,
         window_height = 720
@@ -0,0 +1,65 @@
+// Microbenchmark for the batched AABB overlap kernel used by CollisionSystem.
+// Tests every box in a random scene against a window of neighbours, once with
+// the scalar pair test and once with the SIMD batch kernel, and prints the
+// pair tests per second of each.
+//
+// Build and run with: make bench
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include "../src/collision/aabb_kernel.h"
+
+const size_t NUM_BOXES = 20000;
+const size_t WINDOW = 64;
+const int REPEATS = 50;
+
+int main() {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(0.0f, 4000.0f);
+    std::uniform_real_distribution<float> extent(4.0f, 64.0f);
+
+    BoundsSoA soa;
+    for (size_t i = 0; i < NUM_BOXES; i++) {
+        float x = position(rng);
+        float y = position(rng);
+        soa.push_back({x, y, x + extent(rng), y + extent(rng)});
+    }
+    soa.pad();
+
+    const size_t tests_per_pass = (NUM_BOXES - WINDOW) * WINDOW;
+    const double total_tests = static_cast<double>(tests_per_pass) * REPEATS;
+
+    // scalar: one pair at a time, the way the old narrowphase did it
+    size_t scalar_hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPEATS; r++) {
+        for (size_t i = 0; i < NUM_BOXES - WINDOW; i++) {
+            const ColliderBounds box = soa.get(i);
+            for (size_t j = i + 1; j <= i + WINDOW; j++) {
+                scalar_hits += bounds_overlap(box, soa.get(j));
+            }
+        }
+    }
+    double scalar_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // batched: AABB_BATCH_WIDTH candidates per call, hits come back as a bitmask
+    size_t batch_hits = 0;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPEATS; r++) {
+        for (size_t i = 0; i < NUM_BOXES - WINDOW; i++) {
+            const ColliderBounds box = soa.get(i);
+            for (size_t j = i + 1; j <= i + WINDOW; j += AABB_BATCH_WIDTH) {
+                batch_hits += __builtin_popcount(aabb_overlap_batch(box, soa, j));
+            }
+        }
+    }
+    double batch_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("boxes: %zu, window: %zu, batch width: %zu\n", NUM_BOXES, WINDOW, AABB_BATCH_WIDTH);
+    std::printf("scalar : %8.1f M pair tests/s (%zu hits)\n", total_tests / scalar_seconds / 1e6, scalar_hits);
+    std::printf("batched: %8.1f M pair tests/s (%zu hits)\n", total_tests / batch_seconds / 1e6, batch_hits);
+    std::printf("speedup: %.2fx\n", scalar_seconds / batch_seconds);
+
+    return scalar_hits == batch_hits ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// Checks the collision broadphase and narrowphase against brute force.
+// Random boxes, some of them spanning several grid cells, some snapped to
+// the cell edges and a few far away to force the grid to coarsen, are put
+// through BroadphaseGrid and Narrowphase with one thread and with several.
+// Every run must return exactly the pairs an O(n^2) test finds, each pair
+// once, which is what BroadphaseGrid::owns_pair() promises. Also prints how
+// long the grid build plus narrowphase takes next to the brute force.
+//
+// Build and run with: make bench
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../src/collision/broadphase_grid.h"
+#include "../src/collision/narrowphase.h"
+
+const int NUM_WORKERS = 7;
+const size_t NUM_BOXES = 5000;
+const float WORLD_SIZE = 4000.0f;
+const float CELL_SIZE = 128.0f;
+const int ROUNDS = 20;
+
+void make_boxes(std::mt19937& random, size_t count, BoundsSoA& bounds) {
+    std::uniform_real_distribution<float> position(0.0f, WORLD_SIZE);
+    std::uniform_real_distribution<float> small_size(4.0f, 64.0f);
+    std::uniform_real_distribution<float> large_size(CELL_SIZE, CELL_SIZE * 4);
+    bounds.clear();
+    for (size_t i = 0; i < count; i++) {
+        float x = position(random);
+        float y = position(random);
+        float w = i % 10 == 0 ? large_size(random) : small_size(random);
+        float h = i % 10 == 0 ? large_size(random) : small_size(random);
+        // corners right on a cell edge, where owns_pair() has to pick one of two cells
+        if (i % 7 == 0) {
+            x = static_cast<int>(x / CELL_SIZE) * CELL_SIZE;
+            y = static_cast<int>(y / CELL_SIZE) * CELL_SIZE;
+        }
+        bounds.push_back({x, y, x + w, y + h});
+    }
+}
+
+void brute_force_pairs(const BoundsSoA& bounds, const std::vector<int>& ids, std::vector<uint64_t>& out) {
+    out.clear();
+    for (size_t a = 0; a < bounds.size(); a++) {
+        for (size_t b = a + 1; b < bounds.size(); b++) {
+            if (bounds_overlap(bounds.get(a), bounds.get(b))) {
+                out.push_back(ContactCache::make_key(ids[a], ids[b]));
+            }
+        }
+    }
+    std::sort(out.begin(), out.end());
+}
+
+int main() {
+    std::mt19937 random(12345);
+    ThreadPool single_thread(0);
+    ThreadPool multi_thread(NUM_WORKERS);
+    BroadphaseGrid grid(CELL_SIZE);
+    Narrowphase narrowphase;
+    auto keep_all = [](uint32_t a, uint32_t b) {
+        return false;
+    };
+
+    BoundsSoA bounds;
+    std::vector<int> ids;
+    std::vector<uint64_t> expected;
+    std::vector<uint64_t> single_result;
+    int failures = 0;
+    size_t total_pairs = 0;
+    double grid_seconds = 0;
+    double brute_force_seconds = 0;
+
+    for (int round = 0; round < ROUNDS; round++) {
+        make_boxes(random, NUM_BOXES, bounds);
+        // every other round, two stray boxes far outside the world make the grid double its cell size
+        if (round % 2 == 1) {
+            bounds.push_back({-1e6f, -1e6f, -1e6f + 10, -1e6f + 10});
+            bounds.push_back({1e6f, 1e6f, 1e6f + 10, 1e6f + 10});
+        }
+        // ids unrelated to the collider order, like entity ids
+        ids.resize(bounds.size());
+        for (size_t i = 0; i < ids.size(); i++) {
+            ids[i] = static_cast<int>(i);
+        }
+        std::shuffle(ids.begin(), ids.end(), random);
+
+        auto start = std::chrono::steady_clock::now();
+        brute_force_pairs(bounds, ids, expected);
+        brute_force_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        grid.build(bounds);
+        single_result = narrowphase.find_pairs(single_thread, grid, bounds, ids, keep_all);
+
+        start = std::chrono::steady_clock::now();
+        grid.build(bounds);
+        const auto& multi_result = narrowphase.find_pairs(multi_thread, grid, bounds, ids, keep_all);
+        grid_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        total_pairs += expected.size();
+        if (single_result != expected) {
+            failures++;
+            printf("round %d: 1 thread found %zu pairs, brute force %zu\n", round, single_result.size(), expected.size());
+        }
+        if (multi_result != expected) {
+            failures++;
+            printf("round %d: %zu threads found %zu pairs, brute force %zu\n", round, multi_thread.get_thread_count(), multi_result.size(), expected.size());
+        }
+    }
+    printf("%d rounds, %zu boxes, %zu pairs, 1 and %zu threads: %s\n", ROUNDS, NUM_BOXES, total_pairs, multi_thread.get_thread_count(), failures == 0 ? "same as brute force" : "FAILED");
+    printf("grid + narrowphase %.3f ms, brute force %.3f ms per round\n", grid_seconds * 1000 / ROUNDS, brute_force_seconds * 1000 / ROUNDS);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+// Stress test for the EventBus per-thread event lanes.
+// Several threads pull jobs off a shared counter, so which thread produces
+// which event changes from round to round, and queue events into their own
+// lane. After every sync point the delivered sequence must match the one a
+// single thread would produce. Also checks that a full lane drops events
+// instead of growing, and prints the queue + merge + deliver throughput.
+//
+// Build and run with: make bench
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "../src/event_bus/event_bus.h"
+
+const size_t NUM_THREADS = 8;
+const size_t NUM_ITEMS = 100000;
+const size_t ITEMS_PER_JOB = 64;
+const int ROUNDS = 50;
+
+class ItemEvent: public Event {
+    public:
+        uint32_t item;
+        uint32_t part;
+        ItemEvent(uint32_t item, uint32_t part): item(item), part(part) {}
+};
+
+// a second type, first touched from the worker threads
+class OtherEvent: public Event {
+    public:
+        uint32_t item;
+        OtherEvent(uint32_t item): item(item) {}
+};
+
+class Receiver {
+    public:
+        std::vector<ItemEvent> items;
+        size_t others = 0;
+
+        void on_items(EventSpan<ItemEvent> events) {
+            items.insert(items.end(), events.begin(), events.end());
+        }
+
+        void on_other(OtherEvent& event) {
+            others++;
+        }
+};
+
+// how many events the item produces, some produce none and some several
+uint32_t parts_of(size_t item) {
+    return (item * 2654435761u >> 7) % 3;
+}
+
+void produce(EventBus& event_bus, size_t num_items, std::atomic<size_t>& next_job, size_t thread_index) {
+    while (true) {
+        size_t begin = next_job.fetch_add(ITEMS_PER_JOB);
+        if (begin >= num_items) {
+            return;
+        }
+        size_t end = std::min(num_items, begin + ITEMS_PER_JOB);
+        for (size_t item = begin; item < end; item++) {
+            for (uint32_t part = 0; part < parts_of(item); part++) {
+                event_bus.queue_event_from_thread<ItemEvent>(thread_index, item, static_cast<uint32_t>(item), part);
+            }
+            if (item % 97 == 0) {
+                event_bus.queue_event_from_thread<OtherEvent>(thread_index, item, static_cast<uint32_t>(item));
+            }
+        }
+    }
+}
+
+void run_round(EventBus& event_bus, size_t num_items) {
+    std::atomic<size_t> next_job(0);
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < NUM_THREADS; t++) {
+        threads.emplace_back(produce, std::ref(event_bus), num_items, std::ref(next_job), t);
+    }
+    produce(event_bus, num_items, next_job, 0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    event_bus.dispatch_queued();
+}
+
+int main() {
+    EventBus event_bus;
+    event_bus.set_thread_count(NUM_THREADS);
+    // room for every event in one lane, a single thread may well end up doing all the jobs
+    event_bus.set_max_events_per_lane(NUM_ITEMS * 2);
+    Receiver receiver;
+    event_bus.subscribe_to_event_batch<&Receiver::on_items>(&receiver);
+    event_bus.subscribe_to_event<&Receiver::on_other>(&receiver);
+
+    std::vector<ItemEvent> expected;
+    size_t expected_others = 0;
+    for (size_t item = 0; item < NUM_ITEMS; item++) {
+        for (uint32_t part = 0; part < parts_of(item); part++) {
+            expected.emplace_back(static_cast<uint32_t>(item), part);
+        }
+        expected_others += item % 97 == 0;
+    }
+
+    int failures = 0;
+    double seconds = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        receiver.items.clear();
+        receiver.others = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        run_round(event_bus, NUM_ITEMS);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        bool same = receiver.items.size() == expected.size() && receiver.others == expected_others;
+        for (size_t i = 0; same && i < expected.size(); i++) {
+            same = receiver.items[i].item == expected[i].item && receiver.items[i].part == expected[i].part;
+        }
+        if (!same) {
+            failures++;
+            printf("round %d: delivered order differs from the single threaded order\n", round);
+        }
+    }
+    printf("%d rounds, %zu threads, %zu events per round: %s\n", ROUNDS, NUM_THREADS, expected.size(), failures == 0 ? "deterministic" : "FAILED");
+    printf("%.1f M events/s queued, merged and delivered\n", expected.size() * ROUNDS / seconds / 1e6);
+
+    // bounded memory, a lane that fills up drops the rest and the next sync point reports it
+    const size_t cap = 1000;
+    event_bus.set_max_events_per_lane(cap);
+    receiver.items.clear();
+    run_round(event_bus, NUM_ITEMS);
+    bool bounded = receiver.items.size() <= cap * NUM_THREADS;
+    printf("lane cap %zu: %zu events delivered, %s\n", cap, receiver.items.size(), bounded ? "bounded" : "FAILED");
+
+    return failures == 0 && bounded ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// Checks that solid tiles block enemies end to end.
+// Loads a small TileMap with a wall of solid ids and checks find_solid()
+// on boxes around it. Then it runs MovementSystem and CollisionSystem over
+// an enemy walking into the wall. The TileCollisionEvent has to reach
+// MovementSystem and turn the enemy around once, on the frame it enters
+// the wall. A collider that isn't an enemy keeps going straight through.
+//
+// Build and run with: make bench
+
+#include <cstdio>
+#include <memory>
+#include "../src/ecs/ecs.h"
+#include "../src/event_bus/event_bus.h"
+#include "../src/jobs/thread_pool.h"
+#include "../src/tilemap/tile_map.h"
+#include "../src/components/transform_component.h"
+#include "../src/components/rigid_body_component.h"
+#include "../src/components/sprite_component.h"
+#include "../src/components/box_collider_component.h"
+#include "../src/systems/movement_system.h"
+#include "../src/systems/collision_system.h"
+
+const float TILE_SIZE = 64.0f;
+const int WALL = 5;
+const int WATER = 12;
+const int GRASS = 0;
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        failures++;
+        printf("FAILED: %s\n", what);
+    }
+}
+
+void check_find_solid(const TileMap& tile_map) {
+    int column = -1;
+    int row = -1;
+    check(!tile_map.find_solid(10, 10, 300, 60, column, row), "open ground is not solid");
+    check(tile_map.find_solid(300, 10, 330, 60, column, row) && column == 5 && row == 0, "box overlapping the wall finds column 5, row 0");
+    // max edges are exclusive, ending exactly on the wall's left border doesn't touch it
+    check(!tile_map.find_solid(256, 10, 320, 60, column, row), "box ending on the wall border is not solid");
+    check(tile_map.find_solid(10, 200, 60, 250, column, row) && column == 0 && row == 3, "water tile is solid");
+    check(!tile_map.find_solid(-500, -500, -400, -400, column, row), "box outside the map is not solid");
+    check(tile_map.is_solid(5, 2) && !tile_map.is_solid(4, 2) && !tile_map.is_solid(-1, 0), "is_solid follows the tile ids");
+
+    TileMap open_map;
+    open_map.load({{WALL, WATER}, {WALL, WATER}}, TILE_SIZE, {});
+    check(!open_map.find_solid(0, 0, 128, 128, column, row), "no solid ids, no solid tiles");
+}
+
+int main() {
+    // 8 x 4 tiles, a wall down column 5 and one water tile at the bottom left
+    std::unique_ptr<TileMap> tile_map = std::make_unique<TileMap>();
+    std::vector<std::vector<int>> tiles;
+    for (int y = 0; y < 4; y++) {
+        std::vector<int> row(8, GRASS);
+        row[5] = WALL;
+        tiles.push_back(row);
+    }
+    tiles[3][0] = WATER;
+    tile_map->load(tiles, TILE_SIZE, {WALL, WATER, -1});
+    check_find_solid(*tile_map);
+
+    std::unique_ptr<Registry> registry = std::make_unique<Registry>();
+    std::unique_ptr<EventBus> event_bus = std::make_unique<EventBus>();
+    std::unique_ptr<ThreadPool> thread_pool = std::make_unique<ThreadPool>(3);
+    event_bus->set_thread_count(thread_pool->get_thread_count());
+    registry->add_system<MovementSystem>();
+    registry->add_system<CollisionSystem>();
+    registry->get_system<MovementSystem>().subscribe_to_events(event_bus);
+
+    // both start in row 1 heading right at the wall, which begins at x = 320
+    Entity enemy = registry->create_entity();
+    enemy.Group("enemies");
+    enemy.add_component<TransformComponent>(glm::vec2(200, 80));
+    enemy.add_component<RigidBodyComponent>(glm::vec2(100, 0));
+    enemy.add_component<SpriteComponent>("tank-texture", 32, 32, GROUND_LAYER);
+    enemy.add_component<BoxColliderComponent>(32, 32);
+
+    Entity bystander = registry->create_entity();
+    bystander.add_component<TransformComponent>(glm::vec2(200, 150));
+    bystander.add_component<RigidBodyComponent>(glm::vec2(100, 0));
+    bystander.add_component<SpriteComponent>("truck-texture", 32, 32, GROUND_LAYER);
+    bystander.add_component<BoxColliderComponent>(32, 32);
+    registry->Update();
+
+    const float delta_time = 1.0f / 60.0f;
+    int bounces = 0;
+    float deepest_x = 0;
+    for (int frame = 0; frame < 240; frame++) {
+        float velocity_before = enemy.get_component<RigidBodyComponent>().velocity.x;
+        registry->get_system<MovementSystem>().Update(delta_time, 512, 256);
+        registry->get_system<CollisionSystem>().Update(event_bus, thread_pool, tile_map, false);
+        event_bus->dispatch_queued();
+
+        float enemy_max_x = enemy.get_component<TransformComponent>().position.x + 32;
+        deepest_x = enemy_max_x > deepest_x ? enemy_max_x : deepest_x;
+        if (enemy.get_component<RigidBodyComponent>().velocity.x != velocity_before) {
+            bounces++;
+            check(enemy_max_x > 320 && enemy_max_x < 320 + 100 * delta_time + 0.01f, "enemy turns around on the frame it enters the wall");
+        }
+    }
+
+    const auto& enemy_rigid_body = enemy.get_component<RigidBodyComponent>();
+    check(bounces == 1, "enemy bounces off the wall exactly once");
+    check(enemy_rigid_body.velocity.x == -100, "enemy walks back the way it came");
+    check(enemy.get_component<SpriteComponent>().flip == SDL_FLIP_HORIZONTAL, "enemy sprite faces the new direction");
+    check(deepest_x < 320 + 100 * delta_time + 0.01f, "enemy never gets past the wall's edge");
+    check(bystander.get_component<RigidBodyComponent>().velocity.x == 100, "colliders outside the enemies group are not turned around");
+    check(bystander.get_component<TransformComponent>().position.x > 384, "non enemy walked through the wall");
+
+    printf("tile collisions: %s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -1,5 +1,8 @@
 #include "asset_store.h"
+#include "skyline_packer.h"
 #include "../logger/logger.h"
+#include "../profiler/profile_scope.h"
+#include <algorithm>
 #include <SDL2/SDL_image.h>
 #include "../game/game.h"
 
@@ -16,36 +19,158 @@ void AssetStore::clear_assets() {
     Logger::Log("Clearing assets...");
     
     // Clear textures
-    for (auto texture : textures) {
-        SDL_DestroyTexture(texture.second);
+    for (auto page : atlas_pages) {
+        SDL_DestroyTexture(page);
     }
-    textures.clear();
+    atlas_pages.clear();
+    for (auto& pending : pending_textures) {
+        SDL_FreeSurface(pending.surface);
+    }
+    pending_textures.clear();
+    texture_regions.clear();
+    texture_handles.clear();
+    atlas_used_area = 0;
+    atlas_page_area = 0;
 
     // Clear fonts
     for (auto font : fonts) {
         TTF_CloseFont(font.second);
     }
     fonts.clear();
+    glyph_atlases.clear();
 }
 
 void AssetStore::add_texture(SDL_Renderer* renderer, std::string asset_id, const std::string& file_path, bool get_white) {
+    PROFILE_SCOPE("AssetStore::add_texture");
     if (Game::verbose_logging) {
         Logger::Log("Adding texture to asset store with id: " + asset_id);
     }
     SDL_Surface* surface = IMG_Load(file_path.c_str());
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    if (!surface) {
+        Logger::Err("Failed to load texture: " + file_path);
+        return;
+    }
     
     // Create a white version of the texture and store it as "asset_id + "_white"
     // This white texture is for a "hit flash" effect when an entity is hit
     if (get_white) {
         SDL_Surface* whiteSurface = ConvertToWhite(surface);
-        SDL_Texture* whiteTexture = SDL_CreateTextureFromSurface(renderer, whiteSurface);
-        SDL_FreeSurface(whiteSurface);
-        textures.emplace(asset_id + "_white", whiteTexture);
+        if (whiteSurface) {
+            add_pending_texture(asset_id + "_white", whiteSurface);
+        }
     }
 
-    SDL_FreeSurface(surface);
-    textures.emplace(asset_id, texture);
+    add_pending_texture(asset_id, surface);
+}
+
+int AssetStore::add_pending_texture(const std::string& asset_id, SDL_Surface* surface) {
+    if (texture_handles.find(asset_id) != texture_handles.end()) {
+        Logger::Err("Texture already in asset store with id: " + asset_id);
+        SDL_FreeSurface(surface);
+        return -1;
+    }
+    int handle = static_cast<int>(texture_regions.size());
+    // page -1 until build_atlases() places it
+    texture_regions.push_back({-1, {0, 0, surface->w, surface->h}});
+    texture_handles.emplace(asset_id, handle);
+    pending_textures.push_back({handle, surface});
+    return handle;
+}
+
+void AssetStore::build_atlases(SDL_Renderer* renderer) {
+    PROFILE_SCOPE("AssetStore::build_atlases");
+    if (pending_textures.empty()) {
+        return;
+    }
+
+    // textures without any transparency keep the no blending they had as standalone textures,
+    // so they get pages of their own
+    auto is_opaque = [](SDL_Surface* surface) {
+        return surface->format->Amask == 0 && !SDL_HasColorKey(surface);
+    };
+
+    // tallest first packs a skyline much tighter
+    std::stable_sort(pending_textures.begin(), pending_textures.end(), [](const PendingTexture& a, const PendingTexture& b) {
+        if (a.surface->h != b.surface->h) {
+            return a.surface->h > b.surface->h;
+        }
+        return a.surface->w > b.surface->w;
+    });
+
+    struct Page {
+        SkylinePacker packer;
+        SDL_Surface* surface;
+        bool is_opaque;
+    };
+    std::vector<Page> pages;
+    int packed_textures = 0;
+
+    for (auto& pending : pending_textures) {
+        SDL_Surface* surface = pending.surface;
+        bool opaque = is_opaque(surface);
+        int padded_width = surface->w + 2 * ATLAS_PADDING;
+        int padded_height = surface->h + 2 * ATLAS_PADDING;
+
+        int page_index = -1;
+        int x = 0;
+        int y = 0;
+        if (padded_width > ATLAS_PAGE_SIZE || padded_height > ATLAS_PAGE_SIZE) {
+            // too big to share a page, it gets one of its own
+            pages.push_back({SkylinePacker(padded_width, padded_height), nullptr, opaque});
+            page_index = static_cast<int>(pages.size()) - 1;
+            pages[page_index].packer.insert(padded_width, padded_height, x, y);
+        } else {
+            for (size_t i = 0; i < pages.size(); i++) {
+                if (pages[i].is_opaque == opaque && pages[i].packer.insert(padded_width, padded_height, x, y)) {
+                    page_index = static_cast<int>(i);
+                    break;
+                }
+            }
+            if (page_index < 0) {
+                pages.push_back({SkylinePacker(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE), nullptr, opaque});
+                page_index = static_cast<int>(pages.size()) - 1;
+                pages[page_index].packer.insert(padded_width, padded_height, x, y);
+            }
+        }
+
+        Page& page = pages[page_index];
+        if (!page.surface) {
+            page.surface = SDL_CreateRGBSurfaceWithFormat(0, page.packer.get_width(), page.packer.get_height(), 32, SDL_PIXELFORMAT_RGBA32);
+            if (!page.surface) {
+                Logger::Err("Failed to create atlas page: " + std::string(SDL_GetError()));
+                continue;
+            }
+        }
+
+        // copy the pixels as they are, alpha included, instead of blending them onto the empty page
+        SDL_Rect dst_rect = {x + ATLAS_PADDING, y + ATLAS_PADDING, surface->w, surface->h};
+        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(surface, NULL, page.surface, &dst_rect);
+
+        texture_regions[pending.handle] = {static_cast<int>(atlas_pages.size()) + page_index, dst_rect};
+        atlas_used_area += static_cast<long long>(surface->w) * surface->h;
+        packed_textures++;
+    }
+
+    for (auto& page : pages) {
+        SDL_Texture* texture = page.surface ? SDL_CreateTextureFromSurface(renderer, page.surface) : nullptr;
+        if (texture) {
+            SDL_SetTextureBlendMode(texture, page.is_opaque ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+        }
+        atlas_pages.push_back(texture);
+        atlas_page_area += static_cast<long long>(page.packer.get_width()) * page.packer.get_height();
+        if (page.surface) {
+            SDL_FreeSurface(page.surface);
+        }
+    }
+
+    for (auto& pending : pending_textures) {
+        SDL_FreeSurface(pending.surface);
+    }
+    pending_textures.clear();
+
+    Logger::Log("Packed " + std::to_string(packed_textures) + " textures into " + std::to_string(pages.size()) + " atlas pages, " +
+        std::to_string(static_cast<int>(get_atlas_occupancy() * 100)) + "% of the atlas area is in use.");
 }
 
 SDL_Surface* AssetStore::ConvertToWhite(SDL_Surface* originalSurface) {
@@ -69,6 +194,7 @@ SDL_Surface* AssetStore::ConvertToWhite(SDL_Surface* originalSurface) {
 }
 
 void AssetStore::add_font(const std::string asset_id, const std::string& file_path, int font_size) {
+    PROFILE_SCOPE("AssetStore::add_font");
     if (Game::verbose_logging) {
         Logger::Log("Adding font to asset store with id: " + asset_id);
     }
@@ -78,6 +204,25 @@ void AssetStore::add_font(const std::string asset_id, const std::string& file_pa
     //     return;
     // }
     fonts.emplace(asset_id, font);
+    if (!font) {
+        Logger::Err("Failed to load font: " + file_path);
+        return;
+    }
+
+    // the glyph sheet is packed with the textures, text is then drawn from the atlas without SDL_ttf
+    GlyphAtlas glyph_atlas;
+    SDL_Surface* sheet = glyph_atlas.build(font);
+    if (sheet) {
+        glyph_atlas.set_texture_handle(add_pending_texture(asset_id + "_glyphs", sheet));
+        if (glyph_atlas.get_texture_handle() >= 0) {
+            glyph_atlases.emplace(asset_id, glyph_atlas);
+        }
+    }
+}
+
+const GlyphAtlas* AssetStore::get_glyph_atlas(const std::string& asset_id) const {
+    auto glyph_atlas = glyph_atlases.find(asset_id);
+    return glyph_atlas == glyph_atlases.end() ? nullptr : &glyph_atlas->second;
 }
 
 TTF_Font* AssetStore::get_font(const std::string& asset_id) {
@@ -89,14 +234,21 @@ TTF_Font* AssetStore::get_font(const std::string& asset_id) {
 }
 
 SDL_Texture* AssetStore::get_texture(const std::string& asset_id) {
-    if (textures.find(asset_id) == textures.end()) {
+    int handle = get_texture_handle(asset_id);
+    return handle < 0 ? nullptr : get_texture(handle);
+}
+
+int AssetStore::get_texture_handle(const std::string& asset_id) const {
+    auto handle = texture_handles.find(asset_id);
+    if (handle == texture_handles.end()) {
         Logger::Err("Texture not found in asset store with id: " + asset_id);
-        return nullptr;
+        return -1;
     }
-    return textures.at(asset_id);
+    return handle->second;
 }
 
 void AssetStore::add_audio(const std::string asset_id, const std::string& file_path) {
+    PROFILE_SCOPE("AssetStore::add_audio");
     if (Game::verbose_logging) {
         
     }
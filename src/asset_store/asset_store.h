@@ -3,29 +3,79 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_mixer.h>
+#include "glyph_atlas.h"
+
+// where a texture ended up: an atlas page and the rectangle it occupies on it
+struct TextureRegion {
+    int page;
+    SDL_Rect rect;
+};
 
 class AssetStore {
     private:
-        std::map<std::string, SDL_Texture*> textures;
+        // handle -> region, handles are given out in load order and stay valid until clear_assets()
+        std::vector<TextureRegion> texture_regions;
+        std::map<std::string, int> texture_handles;
+        std::vector<SDL_Texture*> atlas_pages;
         std::map<std::string, TTF_Font*> fonts;
+        std::map<std::string, GlyphAtlas> glyph_atlases;
         std::map<std::string, Mix_Chunk*> audio_files;
 
+        // textures loaded since the last build_atlases(), still on the CPU side
+        struct PendingTexture {
+            int handle;
+            SDL_Surface* surface;
+        };
+        std::vector<PendingTexture> pending_textures;
+
+        int add_pending_texture(const std::string& asset_id, SDL_Surface* surface);
+
+        static const int ATLAS_PAGE_SIZE = 2048;
+        // empty pixels around every texture, so filtering never picks up a neighbour
+        static const int ATLAS_PADDING = 1;
+        long long atlas_used_area = 0;
+        long long atlas_page_area = 0;
+
     public:
         AssetStore();
         ~AssetStore();
 
         // Texture management
         void clear_assets();
+        // the texture is only usable after the next build_atlases()
         void add_texture(SDL_Renderer* renderer, std::string asset_id, const std::string& file_path, bool get_white);
+        // packs every texture added since the last call into atlas pages
+        void build_atlases(SDL_Renderer* renderer);
+        // the atlas page holding the texture, see get_texture_region for where on it
         SDL_Texture* get_texture(const std::string& asset_id);
+        // resolve the id once and keep the handle, the handle getters are then plain array indexing
+        int get_texture_handle(const std::string& asset_id) const;
+        const TextureRegion* get_texture_region(int handle) const {
+            return handle >= 0 && handle < static_cast<int>(texture_regions.size()) && texture_regions[handle].page >= 0 ? &texture_regions[handle] : nullptr;
+        }
+        SDL_Texture* get_texture(int handle) const {
+            const TextureRegion* region = get_texture_region(handle);
+            return region ? atlas_pages[region->page] : nullptr;
+        }
+        SDL_Texture* get_atlas_page(int page) const {
+            return atlas_pages[page];
+        }
+        int get_atlas_page_count() const { return static_cast<int>(atlas_pages.size()); }
+        // packed texture area over total page area, over every page
+        float get_atlas_occupancy() const {
+            return atlas_page_area > 0 ? static_cast<float>(atlas_used_area) / atlas_page_area : 0.0f;
+        }
         SDL_Surface* ConvertToWhite(SDL_Surface* originalSurface);
 
         // Font management
         void add_font(const std::string asset_id, const std::string& file_path, int font_size);
         TTF_Font* get_font(const std::string& asset_id);
+        // the font's printable ASCII glyphs, usable after the next build_atlases(), nullptr if the font has none
+        const GlyphAtlas* get_glyph_atlas(const std::string& asset_id) const;
 
         // Audio management
         void add_audio(const std::string asset_id, const std::string& file_path);
@@ -0,0 +1,68 @@
+#include "glyph_atlas.h"
+#include "../logger/logger.h"
+#include <algorithm>
+
+SDL_Surface* GlyphAtlas::build(TTF_Font* font) {
+    const int glyph_count = LAST_CHAR - FIRST_CHAR + 1;
+    SDL_Color white = {255, 255, 255, 255};
+
+    SDL_Surface* rendered[glyph_count] = {};
+    int cell_width = 1;
+    line_height = TTF_FontHeight(font);
+    for (int i = 0; i < glyph_count; i++) {
+        Uint16 c = static_cast<Uint16>(FIRST_CHAR + i);
+        int min_x, max_x, min_y, max_y, advance = 0;
+        if (TTF_GlyphIsProvided(font, c)) {
+            TTF_GlyphMetrics(font, c, &min_x, &max_x, &min_y, &max_y, &advance);
+            rendered[i] = TTF_RenderGlyph_Blended(font, c, white);
+        }
+        glyphs[i].advance = advance;
+        if (rendered[i]) {
+            cell_width = std::max(cell_width, rendered[i]->w);
+            line_height = std::max(line_height, rendered[i]->h);
+        }
+    }
+
+    // one empty pixel between cells, so filtering never picks up a neighbour
+    int rows = (glyph_count + GLYPHS_PER_ROW - 1) / GLYPHS_PER_ROW;
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, GLYPHS_PER_ROW * (cell_width + 1), rows * (line_height + 1), 32, SDL_PIXELFORMAT_RGBA32);
+    if (!sheet) {
+        Logger::Err("Failed to create glyph sheet: " + std::string(SDL_GetError()));
+    }
+    for (int i = 0; i < glyph_count; i++) {
+        SDL_Surface* glyph = rendered[i];
+        if (!glyph) {
+            glyphs[i].rect = {0, 0, 0, 0};
+            continue;
+        }
+        glyphs[i].rect = {
+            (i % GLYPHS_PER_ROW) * (cell_width + 1),
+            (i / GLYPHS_PER_ROW) * (line_height + 1),
+            glyph->w,
+            glyph->h
+        };
+        if (sheet) {
+            SDL_SetSurfaceBlendMode(glyph, SDL_BLENDMODE_NONE);
+            // the blit writes back its clipped rectangle, so it gets a copy
+            SDL_Rect dst_rect = glyphs[i].rect;
+            SDL_BlitSurface(glyph, NULL, sheet, &dst_rect);
+        }
+        SDL_FreeSurface(glyph);
+    }
+    return sheet;
+}
+
+bool GlyphAtlas::can_draw(const std::string& text) {
+    return std::all_of(text.begin(), text.end(), has_glyph);
+}
+
+int GlyphAtlas::measure(const std::string& text) const {
+    int width = 0;
+    int pen_x = 0;
+    for (char c : text) {
+        const Glyph& glyph = get_glyph(c);
+        width = std::max(width, pen_x + glyph.rect.w);
+        pen_x += glyph.advance;
+    }
+    return std::max(width, pen_x);
+}
@@ -0,0 +1,56 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <string>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+// where a glyph sits on the font's glyph sheet and how far the pen moves after it
+struct Glyph {
+    SDL_Rect rect;
+    int advance;
+};
+
+///////////////////////////
+// Glyph Atlas
+///////////////////////////
+// Printable ASCII of one font at one size, rasterised once in white onto a
+// single sheet. The sheet goes through the asset store's atlas packing like
+// any other texture, so strings are laid out from the metrics here and drawn
+// as tinted quads through a SpriteBatch, with no SDL_ttf call per string.
+// Glyphs sit on a grid of equal cells, one font line tall, and are drawn at
+// the pen position. Kerning is not applied.
+///////////////////////////
+
+class GlyphAtlas {
+    private:
+        static const int FIRST_CHAR = 32;
+        static const int LAST_CHAR = 126;
+        static const int GLYPHS_PER_ROW = 16;
+
+        Glyph glyphs[LAST_CHAR - FIRST_CHAR + 1] = {};
+        int line_height = 0;
+        int texture_handle = -1;
+
+    public:
+        // rasterises the glyphs and fills in the metrics, the caller owns the returned sheet
+        SDL_Surface* build(TTF_Font* font);
+
+        void set_texture_handle(int handle) { texture_handle = handle; }
+        int get_texture_handle() const { return texture_handle; }
+        int get_line_height() const { return line_height; }
+
+        static bool has_glyph(char c) {
+            return c >= FIRST_CHAR && c <= LAST_CHAR;
+        }
+        // true when every character of the text is on the sheet
+        static bool can_draw(const std::string& text);
+
+        const Glyph& get_glyph(char c) const {
+            return glyphs[c - FIRST_CHAR];
+        }
+        // width of the laid out text in pixels
+        int measure(const std::string& text) const;
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "skyline_packer.h"
+
+SkylinePacker::SkylinePacker(int width, int height) {
+    this->width = width;
+    this->height = height;
+    skyline.push_back({0, 0, width});
+}
+
+int SkylinePacker::fit(size_t index, int rect_width, int rect_height) const {
+    int x = skyline[index].x;
+    if (x + rect_width > width) {
+        return -1;
+    }
+    // the rectangle rests on the highest segment it spans
+    int y = 0;
+    int remaining = rect_width;
+    for (size_t i = index; remaining > 0; i++) {
+        if (i >= skyline.size()) {
+            return -1;
+        }
+        if (skyline[i].y > y) {
+            y = skyline[i].y;
+        }
+        remaining -= skyline[i].width;
+    }
+    if (y + rect_height > height) {
+        return -1;
+    }
+    return y;
+}
+
+bool SkylinePacker::insert(int rect_width, int rect_height, int& x, int& y) {
+    int best_index = -1;
+    int best_top = height + 1;
+    int best_width = width + 1;
+    for (size_t i = 0; i < skyline.size(); i++) {
+        int fit_y = fit(i, rect_width, rect_height);
+        if (fit_y < 0) {
+            continue;
+        }
+        int top = fit_y + rect_height;
+        // lowest top wins, narrower segments break ties so wide gaps stay open for wide sprites
+        if (top < best_top || (top == best_top && skyline[i].width < best_width)) {
+            best_index = static_cast<int>(i);
+            best_top = top;
+            best_width = skyline[i].width;
+        }
+    }
+    if (best_index < 0) {
+        return false;
+    }
+
+    x = skyline[best_index].x;
+    y = best_top - rect_height;
+
+    // the new segment covers [x, x + rect_width), shrink or drop the ones underneath it
+    Segment placed = {x, best_top, rect_width};
+    skyline.insert(skyline.begin() + best_index, placed);
+    size_t i = best_index + 1;
+    while (i < skyline.size()) {
+        Segment& segment = skyline[i];
+        int placed_end = placed.x + placed.width;
+        if (segment.x >= placed_end) {
+            break;
+        }
+        int overlap = placed_end - segment.x;
+        if (overlap >= segment.width) {
+            skyline.erase(skyline.begin() + i);
+            continue;
+        }
+        segment.x += overlap;
+        segment.width -= overlap;
+        break;
+    }
+
+    // merge neighbours at the same height
+    for (size_t j = 0; j + 1 < skyline.size();) {
+        if (skyline[j].y == skyline[j + 1].y) {
+            skyline[j].width += skyline[j + 1].width;
+            skyline.erase(skyline.begin() + j + 1);
+        } else {
+            j++;
+        }
+    }
+
+    used_area += rect_width * rect_height;
+    return true;
+}
+
+float SkylinePacker::get_occupancy() const {
+    return static_cast<float>(used_area) / (static_cast<float>(width) * height);
+}
@@ -0,0 +1,44 @@
+#ifndef SKYLINE_PACKER_H
+#define SKYLINE_PACKER_H
+
+#include <cstddef>
+#include <vector>
+
+///////////////////////////
+// Skyline Packer
+///////////////////////////
+// Packs rectangles into a fixed size page. The packed area is tracked as a
+// skyline, the top edge of everything placed so far, and each rectangle goes
+// where it leaves its top lowest (bottom-left heuristic). Good enough for
+// sprite sheets, which are mostly similar in size.
+///////////////////////////
+
+class SkylinePacker {
+    private:
+        struct Segment {
+            int x;
+            int y;
+            int width;
+        };
+
+        int width;
+        int height;
+        int used_area = 0;
+        std::vector<Segment> skyline;
+
+        // y where a width x height rectangle starting at segment index would sit, -1 if it doesn't fit
+        int fit(size_t index, int rect_width, int rect_height) const;
+
+    public:
+        SkylinePacker(int width, int height);
+
+        // finds room for a rect_width x rect_height rectangle, false when the page is full
+        bool insert(int rect_width, int rect_height, int& x, int& y);
+
+        int get_width() const { return width; }
+        int get_height() const { return height; }
+        // fraction of the page covered by packed rectangles
+        float get_occupancy() const;
+};
+
+#endif
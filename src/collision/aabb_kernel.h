@@ -0,0 +1,144 @@
+#ifndef AABB_KERNEL_H
+#define AABB_KERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#endif
+
+// World space bounds of one collider, min inclusive and max exclusive
+struct ColliderBounds {
+    float min_x;
+    float min_y;
+    float max_x;
+    float max_y;
+};
+
+inline bool bounds_overlap(const ColliderBounds& a, const ColliderBounds& b) {
+    return (
+        a.min_x < b.max_x &&
+        a.max_x > b.min_x &&
+        a.min_y < b.max_y &&
+        a.max_y > b.min_y
+    );
+}
+
+///////////////////////////
+// Bounds SoA
+///////////////////////////
+// The same bounds stored as four separate float arrays, so a batch of
+// neighbouring colliders can be loaded straight into SIMD registers.
+// pad() appends one batch of boxes that can never overlap anything, which
+// lets the kernel read a full batch past the last real collider.
+///////////////////////////
+
+// number of candidates tested by one aabb_overlap_batch() call
+#if defined(__AVX__)
+    const size_t AABB_BATCH_WIDTH = 8;
+#elif defined(__SSE2__) || defined(_M_X64)
+    const size_t AABB_BATCH_WIDTH = 4;
+#else
+    const size_t AABB_BATCH_WIDTH = 1;
+#endif
+
+struct BoundsSoA {
+    std::vector<float> min_x;
+    std::vector<float> min_y;
+    std::vector<float> max_x;
+    std::vector<float> max_y;
+    size_t count = 0;
+
+    void clear() {
+        min_x.clear();
+        min_y.clear();
+        max_x.clear();
+        max_y.clear();
+        count = 0;
+    }
+
+    void push_back(const ColliderBounds& b) {
+        // drop any padding left over from a previous pad()
+        min_x.resize(count);
+        min_y.resize(count);
+        max_x.resize(count);
+        max_y.resize(count);
+        min_x.push_back(b.min_x);
+        min_y.push_back(b.min_y);
+        max_x.push_back(b.max_x);
+        max_y.push_back(b.max_y);
+        count++;
+    }
+
+    void pad() {
+        const float inf = std::numeric_limits<float>::infinity();
+        min_x.resize(count + AABB_BATCH_WIDTH, inf);
+        min_y.resize(count + AABB_BATCH_WIDTH, inf);
+        max_x.resize(count + AABB_BATCH_WIDTH, -inf);
+        max_y.resize(count + AABB_BATCH_WIDTH, -inf);
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    ColliderBounds get(size_t i) const {
+        return {min_x[i], min_y[i], max_x[i], max_y[i]};
+    }
+};
+
+// Tests box against candidates [start, start + AABB_BATCH_WIDTH) one at a time.
+// Bit n of the result is set when candidate start + n overlaps the box.
+inline uint32_t aabb_overlap_batch_scalar(const ColliderBounds& box, const BoundsSoA& soa, size_t start) {
+    uint32_t mask = 0;
+    for (size_t lane = 0; lane < AABB_BATCH_WIDTH; lane++) {
+        size_t i = start + lane;
+        bool overlap = (
+            box.min_x < soa.max_x[i] &&
+            box.max_x > soa.min_x[i] &&
+            box.min_y < soa.max_y[i] &&
+            box.max_y > soa.min_y[i]
+        );
+        mask |= static_cast<uint32_t>(overlap) << lane;
+    }
+    return mask;
+}
+
+// Same as aabb_overlap_batch_scalar(), using one SIMD compare per bound.
+// The arrays must be padded, the load always reads a full batch.
+inline uint32_t aabb_overlap_batch(const ColliderBounds& box, const BoundsSoA& soa, size_t start) {
+#if defined(__AVX__)
+    __m256 hit = _mm256_and_ps(
+        _mm256_and_ps(
+            _mm256_cmp_ps(_mm256_set1_ps(box.min_x), _mm256_loadu_ps(&soa.max_x[start]), _CMP_LT_OQ),
+            _mm256_cmp_ps(_mm256_set1_ps(box.max_x), _mm256_loadu_ps(&soa.min_x[start]), _CMP_GT_OQ)
+        ),
+        _mm256_and_ps(
+            _mm256_cmp_ps(_mm256_set1_ps(box.min_y), _mm256_loadu_ps(&soa.max_y[start]), _CMP_LT_OQ),
+            _mm256_cmp_ps(_mm256_set1_ps(box.max_y), _mm256_loadu_ps(&soa.min_y[start]), _CMP_GT_OQ)
+        )
+    );
+    return static_cast<uint32_t>(_mm256_movemask_ps(hit));
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 hit = _mm_and_ps(
+        _mm_and_ps(
+            _mm_cmplt_ps(_mm_set1_ps(box.min_x), _mm_loadu_ps(&soa.max_x[start])),
+            _mm_cmpgt_ps(_mm_set1_ps(box.max_x), _mm_loadu_ps(&soa.min_x[start]))
+        ),
+        _mm_and_ps(
+            _mm_cmplt_ps(_mm_set1_ps(box.min_y), _mm_loadu_ps(&soa.max_y[start])),
+            _mm_cmpgt_ps(_mm_set1_ps(box.max_y), _mm_loadu_ps(&soa.min_y[start]))
+        )
+    );
+    return static_cast<uint32_t>(_mm_movemask_ps(hit));
+#else
+    return aabb_overlap_batch_scalar(box, soa, start);
+#endif
+}
+
+#endif
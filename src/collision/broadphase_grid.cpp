@@ -0,0 +1,86 @@
+#include "broadphase_grid.h"
+#include <cmath>
+
+// keeps the grid small when a stray collider ends up far outside the map
+const int MAX_GRID_CELLS = 1 << 18;
+
+BroadphaseGrid::BroadphaseGrid(float cell_size) {
+    this->cell_size = cell_size;
+}
+
+int BroadphaseGrid::column_of(float x) const {
+    int column = static_cast<int>((x - origin_x) * inverse_cell_size);
+    return column < 0 ? 0 : (column >= columns ? columns - 1 : column);
+}
+
+int BroadphaseGrid::row_of(float y) const {
+    int row = static_cast<int>((y - origin_y) * inverse_cell_size);
+    return row < 0 ? 0 : (row >= rows ? rows - 1 : row);
+}
+
+void BroadphaseGrid::build(const BoundsSoA& bounds) {
+    active_cells.clear();
+    if (bounds.size() == 0) {
+        columns = rows = 0;
+        cell_start.assign(1, 0);
+        cell_items.clear();
+        return;
+    }
+
+    // fit the grid around everything that exists this frame
+    float min_x = bounds.min_x[0];
+    float min_y = bounds.min_y[0];
+    float max_x = bounds.max_x[0];
+    float max_y = bounds.max_y[0];
+    for (size_t i = 1; i < bounds.size(); i++) {
+        min_x = bounds.min_x[i] < min_x ? bounds.min_x[i] : min_x;
+        min_y = bounds.min_y[i] < min_y ? bounds.min_y[i] : min_y;
+        max_x = bounds.max_x[i] > max_x ? bounds.max_x[i] : max_x;
+        max_y = bounds.max_y[i] > max_y ? bounds.max_y[i] : max_y;
+    }
+
+    float size = cell_size;
+    columns = static_cast<int>(std::ceil((max_x - min_x) / size)) + 1;
+    rows = static_cast<int>(std::ceil((max_y - min_y) / size)) + 1;
+    while (static_cast<long>(columns) * rows > MAX_GRID_CELLS) {
+        size *= 2;
+        columns = static_cast<int>(std::ceil((max_x - min_x) / size)) + 1;
+        rows = static_cast<int>(std::ceil((max_y - min_y) / size)) + 1;
+    }
+    origin_x = min_x;
+    origin_y = min_y;
+    inverse_cell_size = 1.0f / size;
+
+    // counting sort: count the colliders per cell, prefix sum, then scatter
+    size_t num_cells = static_cast<size_t>(columns) * rows;
+    cell_start.assign(num_cells + 1, 0);
+    for (size_t i = 0; i < bounds.size(); i++) {
+        const auto b = bounds.get(i);
+        int x0 = column_of(b.min_x), x1 = column_of(b.max_x);
+        int y0 = row_of(b.min_y), y1 = row_of(b.max_y);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                cell_start[y * columns + x + 1]++;
+            }
+        }
+    }
+    for (size_t c = 0; c < num_cells; c++) {
+        if (cell_start[c + 1] >= 2) {
+            active_cells.push_back(static_cast<uint32_t>(c));
+        }
+        cell_start[c + 1] += cell_start[c];
+    }
+
+    cell_items.resize(cell_start[num_cells]);
+    cell_cursor.assign(cell_start.begin(), cell_start.end() - 1);
+    for (size_t i = 0; i < bounds.size(); i++) {
+        const auto b = bounds.get(i);
+        int x0 = column_of(b.min_x), x1 = column_of(b.max_x);
+        int y0 = row_of(b.min_y), y1 = row_of(b.max_y);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                cell_items[cell_cursor[y * columns + x]++] = static_cast<uint32_t>(i);
+            }
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef BROADPHASE_GRID_H
+#define BROADPHASE_GRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "aabb_kernel.h"
+
+///////////////////////////
+// Broadphase Grid
+///////////////////////////
+// A uniform grid rebuilt from scratch every frame with a counting sort.
+// Every collider is listed in each cell it overlaps, so two colliders can only
+// touch if they share a cell. Cells are independent of each other, which is
+// what lets the narrowphase run them on different threads.
+///////////////////////////
+
+class BroadphaseGrid {
+    private:
+        float cell_size;
+        float origin_x = 0;
+        float origin_y = 0;
+        float inverse_cell_size = 1;
+        int columns = 0;
+        int rows = 0;
+
+        // cell_start[c]..cell_start[c + 1] indexes into cell_items
+        std::vector<uint32_t> cell_start;
+        std::vector<uint32_t> cell_items;
+        std::vector<uint32_t> cell_cursor;
+
+        // cells holding at least two colliders, the only ones worth testing
+        std::vector<uint32_t> active_cells;
+
+    public:
+        BroadphaseGrid(float cell_size = 128.0f);
+
+        void build(const BoundsSoA& bounds);
+
+        int column_of(float x) const;
+        int row_of(float y) const;
+
+        const std::vector<uint32_t>& get_active_cells() const {
+            return active_cells;
+        }
+
+        const uint32_t* cell_begin(uint32_t cell) const {
+            return cell_items.data() + cell_start[cell];
+        }
+
+        const uint32_t* cell_end(uint32_t cell) const {
+            return cell_items.data() + cell_start[cell + 1];
+        }
+
+        // A pair overlapping several cells is seen in all of them. Only the cell that holds the
+        // top left corner of the overlap reports it, so every pair is reported exactly once.
+        bool owns_pair(uint32_t cell, const ColliderBounds& a, const ColliderBounds& b) const {
+            float x = a.min_x > b.min_x ? a.min_x : b.min_x;
+            float y = a.min_y > b.min_y ? a.min_y : b.min_y;
+            return static_cast<uint32_t>(row_of(y) * columns + column_of(x)) == cell;
+        }
+};
+
+#endif
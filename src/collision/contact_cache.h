@@ -0,0 +1,146 @@
+#ifndef CONTACT_CACHE_H
+#define CONTACT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+///////////////////////////
+// Contact Cache
+///////////////////////////
+// Remembers which pairs of entities were touching on previous frames, so the
+// collision system can tell a new contact apart from one that is still going on.
+// Pairs are packed into a single 64-bit key and stored in an open-addressing
+// hash table (linear probing), so a lookup is a multiply, a shift and usually
+// one cache line.
+///////////////////////////
+
+class ContactCache {
+    private:
+        struct Slot {
+            uint64_t key;
+            uint32_t first_frame;
+            uint32_t last_frame;
+        };
+
+        // entity ids are never negative, so these keys can't be produced by make_key()
+        static constexpr uint64_t EMPTY_KEY = ~0ull;
+        static constexpr uint64_t TOMBSTONE_KEY = ~0ull - 1;
+
+        std::vector<Slot> slots;
+        size_t count = 0;
+        size_t tombstones = 0;
+        unsigned int shift = 64;
+
+        size_t home_slot(uint64_t key) const {
+            // fibonacci hashing, the top bits of the product are well mixed
+            return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift);
+        }
+
+        void rehash(size_t new_capacity) {
+            std::vector<Slot> old_slots = std::move(slots);
+            slots.assign(new_capacity, Slot{EMPTY_KEY, 0, 0});
+            shift = 64;
+            for (size_t capacity = new_capacity; capacity > 1; capacity >>= 1) {
+                shift--;
+            }
+            count = 0;
+            tombstones = 0;
+
+            for (const auto& slot : old_slots) {
+                if (slot.key != EMPTY_KEY && slot.key != TOMBSTONE_KEY) {
+                    size_t mask = slots.size() - 1;
+                    size_t i = home_slot(slot.key);
+                    while (slots[i].key != EMPTY_KEY) {
+                        i = (i + 1) & mask;
+                    }
+                    slots[i] = slot;
+                    count++;
+                }
+            }
+        }
+
+    public:
+        ContactCache(size_t initial_capacity = 256) {
+            size_t capacity = 16;
+            while (capacity < initial_capacity) {
+                capacity <<= 1;
+            }
+            rehash(capacity);
+        }
+
+        // packs an unordered pair of entity ids into one key, smallest id in the high bits
+        static uint64_t make_key(int a, int b) {
+            uint32_t lo = static_cast<uint32_t>(a < b ? a : b);
+            uint32_t hi = static_cast<uint32_t>(a < b ? b : a);
+            return (static_cast<uint64_t>(lo) << 32) | hi;
+        }
+
+        static int first_id(uint64_t key) {
+            return static_cast<int>(key >> 32);
+        }
+
+        static int second_id(uint64_t key) {
+            return static_cast<int>(key & 0xFFFFFFFFull);
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        void clear() {
+            for (auto& slot : slots) {
+                slot = Slot{EMPTY_KEY, 0, 0};
+            }
+            count = 0;
+            tombstones = 0;
+        }
+
+        // Marks the pair as touching on this frame.
+        // Returns how many frames the pair has been in contact before this one (0 means a new contact)
+        uint32_t touch(uint64_t key, uint32_t frame) {
+            // keep the table at most 3/4 full, counting tombstones as used
+            if ((count + tombstones + 1) * 4 > slots.size() * 3) {
+                rehash(count * 2 >= slots.size() / 2 ? slots.size() * 2 : slots.size());
+            }
+
+            size_t mask = slots.size() - 1;
+            size_t i = home_slot(key);
+            size_t first_tombstone = slots.size();
+            while (slots[i].key != EMPTY_KEY) {
+                if (slots[i].key == key) {
+                    slots[i].last_frame = frame;
+                    return frame - slots[i].first_frame;
+                }
+                if (slots[i].key == TOMBSTONE_KEY && first_tombstone == slots.size()) {
+                    first_tombstone = i;
+                }
+                i = (i + 1) & mask;
+            }
+
+            if (first_tombstone != slots.size()) {
+                i = first_tombstone;
+                tombstones--;
+            }
+            slots[i] = Slot{key, frame, frame};
+            count++;
+            return 0;
+        }
+
+        // Removes every pair that was not touched on this frame and hands its key to on_end
+        template <typename TFunc>
+        void sweep(uint32_t frame, TFunc&& on_end) {
+            for (auto& slot : slots) {
+                if (slot.key == EMPTY_KEY || slot.key == TOMBSTONE_KEY || slot.last_frame == frame) {
+                    continue;
+                }
+                uint64_t key = slot.key;
+                slot.key = TOMBSTONE_KEY;
+                count--;
+                tombstones++;
+                on_end(key);
+            }
+        }
+};
+
+#endif
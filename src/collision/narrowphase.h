@@ -0,0 +1,94 @@
+#ifndef NARROWPHASE_H
+#define NARROWPHASE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "aabb_kernel.h"
+#include "broadphase_grid.h"
+#include "contact_cache.h"
+#include "../jobs/thread_pool.h"
+
+///////////////////////////
+// Narrowphase
+///////////////////////////
+// Tests the colliders of every active grid cell against each other, a cell
+// per thread at a time. Each thread writes into its own buffer and the
+// buffers are merged and sorted afterwards, so the pairs come out the same
+// no matter how many threads ran or which cells each of them got.
+///////////////////////////
+
+class Narrowphase {
+    private:
+        // per thread scratch space, padded to a cache line so the threads don't share one
+        struct alignas(64) ContactBuffer {
+            std::vector<uint64_t> keys;
+            // the bounds of the cell being tested, copied next to each other for the SIMD kernel
+            BoundsSoA cell_bounds;
+        };
+        std::vector<ContactBuffer> thread_contacts;
+        std::vector<uint64_t> contacts;
+
+        // number of grid cells handed to a worker at a time
+        static const size_t CELLS_PER_JOB = 16;
+
+    public:
+        // Returns the ContactCache key of every overlapping pair, sorted, each pair once.
+        // ids maps a collider index to the id used in the key, skip_pair(a, b) drops a
+        // pair of collider indices before it is keyed. The grid must be built from bounds.
+        template <typename SkipPair>
+        const std::vector<uint64_t>& find_pairs(ThreadPool& thread_pool, const BroadphaseGrid& grid, const BoundsSoA& bounds, const std::vector<int>& ids, const SkipPair& skip_pair) {
+            thread_contacts.resize(thread_pool.get_thread_count());
+            for (auto& buffer : thread_contacts) {
+                buffer.keys.clear();
+            }
+            const auto& active_cells = grid.get_active_cells();
+            thread_pool.parallel_for(active_cells.size(), CELLS_PER_JOB, [&](size_t begin, size_t end, size_t thread_index) {
+                auto& out = thread_contacts[thread_index].keys;
+                auto& cell_bounds = thread_contacts[thread_index].cell_bounds;
+                for (size_t c = begin; c < end; c++) {
+                    uint32_t cell = active_cells[c];
+                    const uint32_t* items = grid.cell_begin(cell);
+                    size_t count = grid.cell_end(cell) - items;
+
+                    cell_bounds.clear();
+                    for (size_t i = 0; i < count; i++) {
+                        cell_bounds.push_back(bounds.get(items[i]));
+                    }
+                    cell_bounds.pad();
+
+                    for (size_t i = 0; i < count; i++) {
+                        const ColliderBounds box = cell_bounds.get(i);
+                        // test the box against every later collider in the cell, a batch at a time
+                        for (size_t j = i + 1; j < count; j += AABB_BATCH_WIDTH) {
+                            uint32_t hits = aabb_overlap_batch(box, cell_bounds, j);
+                            while (hits != 0) {
+                                size_t k = j + __builtin_ctz(hits);
+                                hits &= hits - 1;
+
+                                uint32_t a = items[i];
+                                uint32_t b = items[k];
+                                if (skip_pair(a, b)) {
+                                    continue;
+                                }
+                                if (grid.owns_pair(cell, box, cell_bounds.get(k))) {
+                                    out.push_back(ContactCache::make_key(ids[a], ids[b]));
+                                }
+                            }
+                        }
+                    }
+                }
+            });
+
+            // merge in pair order, so the result doesn't depend on the thread count
+            contacts.clear();
+            for (const auto& buffer : thread_contacts) {
+                contacts.insert(contacts.end(), buffer.keys.begin(), buffer.keys.end());
+            }
+            std::sort(contacts.begin(), contacts.end());
+            return contacts;
+        }
+};
+
+#endif
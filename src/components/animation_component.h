@@ -2,6 +2,7 @@
 #define ANIMATION_COMPONENT_H
 
 #include <SDL2/SDL.h>
+#include "../timing/clock.h"
 
 struct AnimationComponent {
     int num_frames;
@@ -15,7 +16,7 @@ struct AnimationComponent {
         this->current_frame = 1;
         this->frame_rate_speed = frame_rate_speed;
         this->is_looped = is_looped;
-        this->start_time = SDL_GetTicks();
+        this->start_time = Clock::get_ticks();
     }
 };
 
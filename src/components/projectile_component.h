@@ -2,6 +2,7 @@
 #define PROJECTILE_COMPONENT_H
 
 #include <SDL2/SDL.h>
+#include "../timing/clock.h"
 
 struct ProjectileComponent {
     bool is_friendly;
@@ -13,7 +14,7 @@ struct ProjectileComponent {
         this->is_friendly = is_friendly;
         this->hit_damage = hit_damage;
         this->duration = duration;
-        this->start_time = SDL_GetTicks();
+        this->start_time = Clock::get_ticks();
     }
 };
 
@@ -2,6 +2,7 @@
 #define PROJECTILE_EMITTER_COMPONENT_H
 
 #include <SDL2/SDL.h>
+#include "../timing/clock.h"
 #include <glm/glm.hpp>
 
 struct ProjectileEmitterComponent {
@@ -18,7 +19,7 @@ struct ProjectileEmitterComponent {
         this->projectile_duration = projectile_duration;
         this->hit_damage = hit_damage;
         this->is_friendly = is_friendly;
-        this->last_emission_time = SDL_GetTicks();
+        this->last_emission_time = Clock::get_ticks();
     }
 };
 
@@ -22,10 +22,13 @@ struct SpriteComponent {
     SDL_RendererFlip flip;
     bool is_fixed;
     SDL_Rect src_rect;
+    // simulation steps left to draw the white hit flash, counted down by HitFlashSystem
     int hit_flash;
+    // covered by the fog of war, false keeps the sprite drawn wherever it is, like the player's
     bool is_hidden;
-    bool is_revealed;
-    bool is_visible;
+    // asset store handles, resolved from asset_id on first draw, -1 until then
+    int texture_handle;
+    int white_texture_handle;
 
     SpriteComponent(std::string asset_id ="", int width = 0, int height = 0, SpriteLayer layer = BACKGROUND_LAYER, int src_rect_x = 0, int src_rect_y = 0, bool is_hidden = true) {
         this->asset_id = asset_id;
@@ -36,9 +39,10 @@ struct SpriteComponent {
         this->is_fixed = layer == GUI_LAYER ? true : false;
         this->src_rect = {src_rect_x, src_rect_y, width, height};
         this->hit_flash = 0;
-        this->is_hidden = is_hidden;
-        this->is_revealed = false;
-        this->is_visible = false;
+        // the GUI is drawn in screen space, so fog of war never hides it
+        this->is_hidden = layer == GUI_LAYER ? false : is_hidden;
+        this->texture_handle = -1;
+        this->white_texture_handle = -1;
 
     }
 };
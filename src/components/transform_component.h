@@ -5,11 +5,14 @@
 
 struct TransformComponent {
     glm::vec2 position;
+    // position at the start of the last simulation step, rendering blends from here to position
+    glm::vec2 previous_position;
     glm::vec2 scale;
     double rotation;
 
     TransformComponent(glm::vec2 position = glm::vec2(0,0), glm::vec2 scale = glm::vec2(1,1), double rotation = 0.0) {
         this->position = position;
+        this->previous_position = position;
         this->scale = scale;
         this->rotation = rotation;
     }
@@ -0,0 +1,106 @@
+#include "debug_draw.h"
+#include "../asset_store/asset_store.h"
+#include "../profiler/profile_scope.h"
+#include <cmath>
+
+void DebugDraw::begin(const AssetStore& asset_store, const std::string& font_id) {
+    for (auto& bucket : rect_buckets) {
+        bucket.rects.clear();
+    }
+    line_vertices.clear();
+    line_indices.clear();
+    text_batch.begin(asset_store);
+    glyph_atlas = asset_store.get_glyph_atlas(font_id);
+    primitives = 0;
+}
+
+DebugDraw::RectBucket& DebugDraw::bucket_for(SDL_Color color) {
+    // debug overlays use a handful of colors, a linear scan beats hashing
+    uint32_t key = (static_cast<uint32_t>(color.r) << 24) | (static_cast<uint32_t>(color.g) << 16) |
+        (static_cast<uint32_t>(color.b) << 8) | static_cast<uint32_t>(color.a);
+    for (auto& bucket : rect_buckets) {
+        if (bucket.color_key == key) {
+            return bucket;
+        }
+    }
+    rect_buckets.push_back({key, color, {}});
+    return rect_buckets.back();
+}
+
+void DebugDraw::rect(const SDL_Rect& rect, SDL_Color color) {
+    bucket_for(color).rects.push_back(rect);
+    primitives++;
+}
+
+void DebugDraw::line(float x0, float y0, float x1, float y1, SDL_Color color) {
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    float length = std::sqrt(dx * dx + dy * dy);
+    if (length <= 0.0f) {
+        return;
+    }
+    // a one pixel wide quad along the line
+    float nx = -dy / length * 0.5f;
+    float ny = dx / length * 0.5f;
+    int first = static_cast<int>(line_vertices.size());
+    SDL_FPoint uv = {0.0f, 0.0f};
+    line_vertices.push_back({{x0 + nx, y0 + ny}, color, uv});
+    line_vertices.push_back({{x1 + nx, y1 + ny}, color, uv});
+    line_vertices.push_back({{x1 - nx, y1 - ny}, color, uv});
+    line_vertices.push_back({{x0 - nx, y0 - ny}, color, uv});
+    line_indices.insert(line_indices.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
+    primitives++;
+}
+
+void DebugDraw::circle(float center_x, float center_y, float radius, SDL_Color color, int segments) {
+    const float step = 2.0f * static_cast<float>(M_PI) / segments;
+    float previous_x = center_x + radius;
+    float previous_y = center_y;
+    for (int i = 1; i <= segments; i++) {
+        float x = center_x + radius * std::cos(step * i);
+        float y = center_y + radius * std::sin(step * i);
+        line(previous_x, previous_y, x, y, color);
+        previous_x = x;
+        previous_y = y;
+    }
+}
+
+void DebugDraw::text(float x, float y, const std::string& text, SDL_Color color) {
+    if (!glyph_atlas) {
+        return;
+    }
+    float pen_x = x;
+    for (char c : text) {
+        if (!GlyphAtlas::has_glyph(c)) {
+            continue;
+        }
+        const Glyph& glyph = glyph_atlas->get_glyph(c);
+        if (glyph.rect.w > 0) {
+            SDL_FRect dst_rect = {pen_x, y, static_cast<float>(glyph.rect.w), static_cast<float>(glyph.rect.h)};
+            text_batch.draw(glyph_atlas->get_texture_handle(), glyph.rect, dst_rect, 0.0, SDL_FLIP_NONE, color, 0);
+        }
+        pen_x += glyph.advance;
+    }
+    primitives++;
+}
+
+void DebugDraw::flush(SDL_Renderer* renderer) {
+    PROFILE_SCOPE("DebugDraw::flush");
+    // translucent overlays blend, whatever blend mode was set before is put back after
+    SDL_BlendMode previous_blend_mode;
+    SDL_GetRenderDrawBlendMode(renderer, &previous_blend_mode);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+    for (const auto& bucket : rect_buckets) {
+        if (bucket.rects.empty()) {
+            continue;
+        }
+        SDL_SetRenderDrawColor(renderer, bucket.color.r, bucket.color.g, bucket.color.b, bucket.color.a);
+        SDL_RenderDrawRects(renderer, bucket.rects.data(), static_cast<int>(bucket.rects.size()));
+    }
+    if (!line_indices.empty()) {
+        SDL_RenderGeometry(renderer, NULL, line_vertices.data(), static_cast<int>(line_vertices.size()), line_indices.data(), static_cast<int>(line_indices.size()));
+    }
+    SDL_SetRenderDrawBlendMode(renderer, previous_blend_mode);
+    text_batch.flush(renderer);
+}
@@ -0,0 +1,61 @@
+#ifndef DEBUG_DRAW_H
+#define DEBUG_DRAW_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+#include "../renderer/sprite_batch.h"
+
+class AssetStore;
+class GlyphAtlas;
+
+///////////////////////////
+// Debug Draw
+///////////////////////////
+// Immediate mode debug shapes in screen space. Calls only record into
+// per-color arrays, nothing is drawn until flush():
+// - rect outlines go out with one SDL_RenderDrawRects per color
+// - lines and circles become thin quads drawn with one SDL_RenderGeometry
+// - text is laid out from a font's glyph atlas and drawn through a SpriteBatch
+// The arrays keep their capacity from frame to frame.
+///////////////////////////
+
+class DebugDraw {
+    private:
+        struct RectBucket {
+            uint32_t color_key;
+            SDL_Color color;
+            std::vector<SDL_Rect> rects;
+        };
+        std::vector<RectBucket> rect_buckets;
+
+        std::vector<SDL_Vertex> line_vertices;
+        std::vector<int> line_indices;
+
+        SpriteBatch text_batch;
+        const GlyphAtlas* glyph_atlas = nullptr;
+        int primitives = 0;
+
+        RectBucket& bucket_for(SDL_Color color);
+
+    public:
+        DebugDraw() = default;
+
+        // text is drawn with the glyphs of font_id, no text is drawn if the font has none
+        void begin(const AssetStore& asset_store, const std::string& font_id);
+
+        void rect(const SDL_Rect& rect, SDL_Color color);
+        void line(float x0, float y0, float x1, float y1, SDL_Color color);
+        void circle(float center_x, float center_y, float radius, SDL_Color color, int segments = 24);
+        // printable ASCII only, anything else is skipped
+        void text(float x, float y, const std::string& text, SDL_Color color);
+
+        // draws everything recorded since begin()
+        void flush(SDL_Renderer* renderer);
+
+        // shapes recorded in the last frame
+        int get_primitive_count() const { return primitives; }
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "ecs.h"
 #include "../logger/logger.h"
+#include "../profiler/profile_scope.h"
 #include "../game/game.h"
 
 int IComponent::next_id = 0;
@@ -101,7 +102,8 @@ bool Registry::entity_has_tag(Entity entity, const std::string& tag) const {
     if (tag_per_entity.find(entity.get_id()) == tag_per_entity.end()) {
         return false;
     }
-    return entity_per_tag.find(tag)->second == entity;
+    auto tagged_entity = entity_per_tag.find(tag);
+    return tagged_entity != entity_per_tag.end() && tagged_entity->second == entity;
 }
 
 Entity Registry::get_entity_by_tag(const std::string& tag) const {
@@ -130,8 +132,8 @@ bool Registry::entity_belongs_to_group(Entity entity, const std::string& group)
     if (entities_per_group.find(group) == entities_per_group.end()) {
         return false;
     }
-    auto group_entities = entities_per_group.at(group);
-    return group_entities.find(entity.get_id()) != group_entities.end();
+    const auto& group_entities = entities_per_group.at(group);
+    return group_entities.find(entity) != group_entities.end();
 }
 
 std::vector<Entity> Registry::get_entities_by_group(const std::string& group) const {
@@ -158,6 +160,7 @@ void Registry::remove_entity_group(Entity entity) {
 }
 
 void Registry::Update() {
+    PROFILE_SCOPE("Registry::Update");
     // add entities that are waiting to be added
     for (auto entity: entities_to_be_added) {
         add_entity_to_systems(entity);
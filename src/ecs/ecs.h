@@ -7,6 +7,7 @@
 #include <typeindex>
 #include <set>
 #include <deque>
+#include <memory>
 #include "../logger/logger.h"
 
 const unsigned int MAX_COMPONENTS = 32;
@@ -242,6 +243,8 @@ class Registry {
         // entity management
         Entity create_entity();
         void kill_entity(Entity entity);
+        // live entities, the ones waiting for the next update() included
+        int get_entity_count() const { return num_entities - static_cast<int>(free_ids.size()); }
 
         // tag management
         void tag_entity(Entity entity, const std::string& tag);
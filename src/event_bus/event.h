@@ -1,9 +1,27 @@
 #ifndef EVENT_H
 #define EVENT_H
 
+#include <atomic>
+
 class Event {
     public:
         Event() = default;
 };
 
+struct IEventType {
+    protected:
+        // atomic, worker threads may be the first to touch an event type
+        inline static std::atomic<int> next_id{0};
+};
+
+template <typename TEvent>
+class EventType: public IEventType {
+    public:
+        // Returns the unique id of TEvent, ids are handed out in first use order starting at 0
+        static int get_id() {
+            static auto id = next_id++;
+            return id;
+        }
+};
+
 #endif
@@ -0,0 +1,69 @@
+#ifndef EVENT_ARENA_H
+#define EVENT_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+///////////////////////////
+// Event Arena
+///////////////////////////
+// Bump allocator for the events queued during one frame. Allocating is a
+// pointer increment and everything is released at once by reset(), which
+// keeps the blocks around so a steady frame never touches the heap.
+// Nothing is destroyed on reset, only trivially destructible types belong here.
+///////////////////////////
+
+class EventArena {
+    private:
+        static const size_t BLOCK_SIZE = 64 * 1024;
+
+        struct Block {
+            std::unique_ptr<unsigned char[]> memory;
+            size_t size;
+        };
+        std::vector<Block> blocks;
+        size_t current_block = 0;
+        size_t offset = 0;
+
+    public:
+        EventArena() = default;
+
+        void* allocate(size_t size, size_t alignment) {
+            while (current_block < blocks.size()) {
+                Block& block = blocks[current_block];
+                uintptr_t base = reinterpret_cast<uintptr_t>(block.memory.get());
+                size_t aligned = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+                if (aligned + size <= block.size) {
+                    offset = aligned + size;
+                    return block.memory.get() + aligned;
+                }
+                current_block++;
+                offset = 0;
+            }
+
+            // out of blocks, oversized requests get a block of their own
+            size_t block_size = size + alignment > BLOCK_SIZE ? size + alignment : BLOCK_SIZE;
+            blocks.push_back({std::make_unique<unsigned char[]>(block_size), block_size});
+            current_block = blocks.size() - 1;
+            offset = 0;
+            return allocate(size, alignment);
+        }
+
+        // everything allocated so far is invalid after this
+        void reset() {
+            current_block = 0;
+            offset = 0;
+        }
+
+        size_t capacity() const {
+            size_t total = 0;
+            for (const auto& block : blocks) {
+                total += block.size;
+            }
+            return total;
+        }
+};
+
+#endif
@@ -2,47 +2,280 @@
 #define EVENT_BUS_H
 
 #include "../logger/logger.h"
-#include <map>
-#include <typeindex>
-#include <list>
+#include "../profiler/profile_scope.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <vector>
 #include "event.h"
+#include "event_arena.h"
 
-class IEventCallback {
+// pulls the owner and event types out of a "void (TOwner::*)(TEvent&)" member function pointer
+template <typename TCallback>
+struct EventCallbackTraits;
+
+template <typename TOwner, typename TEvent>
+struct EventCallbackTraits<void (TOwner::*)(TEvent&)> {
+    using Owner = TOwner;
+    using EventType = TEvent;
+};
+
+// a read only view over a batch of queued events, laid out next to each other
+template <typename TEvent>
+class EventSpan {
     private:
-        virtual void Call(Event& e) = 0;
+        const TEvent* events;
+        size_t count;
 
     public:
-        virtual ~IEventCallback() = default;
-        void Execute(Event& e)  {
-            Call(e);
-        }
+        EventSpan(const TEvent* events, size_t count): events(events), count(count) {}
+
+        const TEvent* begin() const { return events; }
+        const TEvent* end() const { return events + count; }
+        const TEvent& operator[](size_t i) const { return events[i]; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
 };
 
+template <typename TCallback>
+struct EventBatchCallbackTraits;
+
 template <typename TOwner, typename TEvent>
-class EventCallback: public IEventCallback {
-    private:
-        typedef void (TOwner::*CallbackFunction)(TEvent&);
+struct EventBatchCallbackTraits<void (TOwner::*)(EventSpan<TEvent>)> {
+    using Owner = TOwner;
+    using EventType = TEvent;
+};
 
-        TOwner* owner_instance;
-        CallbackFunction callback_function;
+// returned by subscribe_to_event, pass it to unsubscribe to remove the handler again
+struct EventSubscription {
+    int event_id = -1;
+    uint32_t id = 0;
+};
 
-        virtual void Call(Event& e) override {
-            std::invoke(callback_function, owner_instance, static_cast<TEvent&>(e));
-        }
-    public:
-        EventCallback(TOwner* owner_instance, CallbackFunction callback_function) {
-            this->owner_instance = owner_instance;
-            this->callback_function = callback_function;
-        }
+// a plain function pointer plus the instance it is called on, no virtual call and no allocation
+struct EventHandler {
+    typedef void (*CallbackFunction)(void* owner_instance, Event& event);
 
-        virtual ~EventCallback() override = default;
+    uint32_t id;
+    void* owner_instance;
+    // null once unsubscribed while the list was being dispatched
+    CallbackFunction callback_function;
 };
 
-typedef std::list<std::unique_ptr<IEventCallback>> HandlerList;
+// like EventHandler, but called once with every queued event of its type
+struct EventBatchHandler {
+    typedef void (*CallbackFunction)(void* owner_instance, const void* events, size_t count);
+
+    uint32_t id;
+    void* owner_instance;
+    CallbackFunction callback_function;
+};
+
+struct HandlerList {
+    std::vector<EventHandler> handlers;
+    std::vector<EventBatchHandler> batch_handlers;
+    // number of emits currently walking this list, removals are deferred until it drops to 0
+    int dispatch_depth = 0;
+    bool has_removed = false;
+};
+
+class EventBus;
+
+// the events of one type queued since the last dispatch, stored contiguously in the arena
+struct EventQueue {
+    unsigned char* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+    // events before this index have already been handed to the handlers
+    size_t delivered = 0;
+    // hands events [start, start + count) to the handlers, knows the real event type
+    void (*deliver)(EventBus& event_bus, int event_id, unsigned char* data, size_t start, size_t count) = nullptr;
+};
+
+// events queued by one worker thread, only that thread writes here until the next sync point
+struct EventLaneQueue {
+    std::vector<unsigned char> data;
+    // caller supplied sort keys, one per event
+    std::vector<uint64_t> order_keys;
+    size_t size = 0;
+    size_t dropped = 0;
+    size_t element_size = 0;
+    size_t alignment = 0;
+    void (*deliver)(EventBus& event_bus, int event_id, unsigned char* data, size_t start, size_t count) = nullptr;
+};
+
+// padded to a cache line so neighbouring lanes don't share one
+struct alignas(64) EventLane {
+    // indexed by event id
+    std::vector<EventLaneQueue> queues;
+};
 
 class EventBus {
     private:
-        std::map<std::type_index, std::unique_ptr<HandlerList>> subscribers;
+        // indexed by EventType<TEvent>::get_id()
+        std::vector<HandlerList> subscribers;
+        uint32_t next_subscription_id = 1;
+
+        // queued mode, indexed like subscribers
+        std::vector<EventQueue> queues;
+        EventArena arena;
+        bool is_dispatching_queued = false;
+
+        // per thread lanes for queue_event_from_thread, merged into the queues above at the sync point
+        std::vector<EventLane> lanes;
+        size_t max_events_per_lane = 1 << 16;
+        struct LaneEvent {
+            uint64_t order_key;
+            uint32_t lane;
+            uint32_t index;
+        };
+        std::vector<LaneEvent> merge_order;
+
+        // drop the handlers that were unsubscribed during a dispatch
+        static void compact(HandlerList& list) {
+            auto& handlers = list.handlers;
+            handlers.erase(std::remove_if(handlers.begin(), handlers.end(), [](const EventHandler& handler) {
+                return handler.callback_function == nullptr;
+            }), handlers.end());
+            auto& batch_handlers = list.batch_handlers;
+            batch_handlers.erase(std::remove_if(batch_handlers.begin(), batch_handlers.end(), [](const EventBatchHandler& handler) {
+                return handler.callback_function == nullptr;
+            }), batch_handlers.end());
+            list.has_removed = false;
+        }
+
+        HandlerList& get_handler_list(int event_id) {
+            if (event_id >= static_cast<int>(subscribers.size())) {
+                subscribers.resize(event_id + 1);
+            }
+            return subscribers[event_id];
+        }
+
+        void begin_dispatch(int event_id) {
+            subscribers[event_id].dispatch_depth++;
+        }
+
+        void end_dispatch(int event_id) {
+            HandlerList& handler_list = subscribers[event_id];
+            handler_list.dispatch_depth--;
+            if (handler_list.dispatch_depth == 0 && handler_list.has_removed) {
+                compact(handler_list);
+            }
+        }
+
+        // calls every per event handler of event_id, handlers subscribed meanwhile only see the next event
+        void dispatch(int event_id, Event& event) {
+            size_t count = subscribers[event_id].handlers.size();
+            for (size_t i = 0; i < count; i++) {
+                // index every time, a handler may have subscribed and grown the arrays
+                const EventHandler& handler = subscribers[event_id].handlers[i];
+                if (handler.callback_function) {
+                    handler.callback_function(handler.owner_instance, event);
+                }
+            }
+        }
+
+        // makes room for one more event in the main queue of event_id, returns where to put it
+        unsigned char* grow_queue(int event_id, size_t element_size, size_t alignment) {
+            if (event_id >= static_cast<int>(queues.size())) {
+                queues.resize(event_id + 1);
+            }
+            EventQueue& queue = queues[event_id];
+            if (queue.size == queue.capacity) {
+                // the old buffer stays valid until the arena resets, spans being delivered keep working
+                size_t capacity = queue.capacity == 0 ? 64 : queue.capacity * 2;
+                auto data = static_cast<unsigned char*>(arena.allocate(capacity * element_size, alignment));
+                if (queue.size > 0) {
+                    std::memcpy(data, queue.data, queue.size * element_size);
+                }
+                queue.data = data;
+                queue.capacity = capacity;
+            }
+            return queue.data + queue.size++ * element_size;
+        }
+
+        // moves the lane events into the main queues, ordered by key then lane then emission order
+        // so the result doesn't depend on which thread ran which job
+        void merge_lanes() {
+            for (size_t event_id = 0; ; event_id++) {
+                bool has_type = false;
+                merge_order.clear();
+                for (size_t lane = 0; lane < lanes.size(); lane++) {
+                    if (event_id >= lanes[lane].queues.size()) {
+                        continue;
+                    }
+                    has_type = true;
+                    EventLaneQueue& queue = lanes[lane].queues[event_id];
+                    for (size_t i = 0; i < queue.size; i++) {
+                        merge_order.push_back({queue.order_keys[i], static_cast<uint32_t>(lane), static_cast<uint32_t>(i)});
+                    }
+                    if (queue.dropped > 0) {
+                        Logger::Err("EventBus lane " + std::to_string(lane) + " dropped " + std::to_string(queue.dropped) + " events of type " + std::to_string(event_id) + ", lane is full.");
+                        queue.dropped = 0;
+                    }
+                }
+                if (!has_type) {
+                    break;
+                }
+                if (merge_order.empty()) {
+                    continue;
+                }
+
+                std::sort(merge_order.begin(), merge_order.end(), [](const LaneEvent& a, const LaneEvent& b) {
+                    if (a.order_key != b.order_key) {
+                        return a.order_key < b.order_key;
+                    }
+                    if (a.lane != b.lane) {
+                        return a.lane < b.lane;
+                    }
+                    return a.index < b.index;
+                });
+
+                const EventLaneQueue& first = lanes[merge_order[0].lane].queues[event_id];
+                size_t element_size = first.element_size;
+                size_t alignment = first.alignment;
+                for (const auto& entry : merge_order) {
+                    const EventLaneQueue& queue = lanes[entry.lane].queues[event_id];
+                    unsigned char* slot = grow_queue(static_cast<int>(event_id), element_size, alignment);
+                    std::memcpy(slot, queue.data.data() + entry.index * element_size, element_size);
+                }
+                queues[event_id].deliver = first.deliver;
+
+                for (auto& lane : lanes) {
+                    if (event_id < lane.queues.size()) {
+                        lane.queues[event_id].size = 0;
+                    }
+                }
+            }
+        }
+
+        template <typename TEvent>
+        static void deliver_queued(EventBus& event_bus, int event_id, unsigned char* data, size_t start, size_t count) {
+            if (event_id >= static_cast<int>(event_bus.subscribers.size())) {
+                return;
+            }
+            TEvent* events = reinterpret_cast<TEvent*>(data) + start;
+            event_bus.begin_dispatch(event_id);
+
+            // batch handlers get the whole run in one call
+            size_t batch_count = event_bus.subscribers[event_id].batch_handlers.size();
+            for (size_t i = 0; i < batch_count; i++) {
+                const EventBatchHandler& handler = event_bus.subscribers[event_id].batch_handlers[i];
+                if (handler.callback_function) {
+                    handler.callback_function(handler.owner_instance, events, count);
+                }
+            }
+            // per event handlers see queued events exactly like emitted ones
+            if (!event_bus.subscribers[event_id].handlers.empty()) {
+                for (size_t i = 0; i < count; i++) {
+                    event_bus.dispatch(event_id, events[i]);
+                }
+            }
+
+            event_bus.end_dispatch(event_id);
+        }
 
     public:
         EventBus() {
@@ -52,44 +285,209 @@ class EventBus {
             Logger::Log("EventBus destroyed.");
         }
 
-        // clears the subscribers list
+        // calls the member function Callback on owner_instance, one of these is stamped out per handler method
+        template <auto Callback>
+        static void trampoline(void* owner_instance, Event& event) {
+            using Traits = EventCallbackTraits<decltype(Callback)>;
+            auto owner = static_cast<typename Traits::Owner*>(owner_instance);
+            (owner->*Callback)(static_cast<typename Traits::EventType&>(event));
+        }
+
+        template <auto Callback>
+        static void batch_trampoline(void* owner_instance, const void* events, size_t count) {
+            using Traits = EventBatchCallbackTraits<decltype(Callback)>;
+            using TEvent = typename Traits::EventType;
+            auto owner = static_cast<typename Traits::Owner*>(owner_instance);
+            (owner->*Callback)(EventSpan<TEvent>(static_cast<const TEvent*>(events), count));
+        }
+
+        // removes every subscriber and drops any queued events, subscriptions otherwise live until unsubscribed
         void reset() {
             subscribers.clear();
+            queues.clear();
+            arena.reset();
+            for (auto& lane : lanes) {
+                lane.queues.clear();
+            }
         }
 
         /////////////////////////////////////////////////////////////////////////////////////////////////
         // subscribe to event type <T>
         // in our implementation, a listener subscribes to an event type by providing a callback function
         // the callback function is a member function of the listener
-        // Example EventBus->SubscribeToEvent<CollisionEvent>(this, &Game::OnCollision);
+        // subscriptions are long lived, subscribe once and keep the handle if you need to unsubscribe
+        // Example event_bus->subscribe_to_event<&Game::on_collision>(this);
+        /////////////////////////////////////////////////////////////////////////////////////////////////
+        template <auto Callback>
+        EventSubscription subscribe_to_event(typename EventCallbackTraits<decltype(Callback)>::Owner* owner_instance) {
+            using TEvent = typename EventCallbackTraits<decltype(Callback)>::EventType;
+            EventSubscription subscription;
+            subscription.event_id = EventType<TEvent>::get_id();
+            subscription.id = next_subscription_id++;
+
+            get_handler_list(subscription.event_id).handlers.push_back({subscription.id, owner_instance, &EventBus::trampoline<Callback>});
+            return subscription;
+        }
+
+        /////////////////////////////////////////////////////////////////////////////////////////////////
+        // subscribe to batches of event type <T>
+        // the callback receives every event of the type queued since the last sync point in one call,
+        // the span is only valid inside the callback
+        // Example event_bus->subscribe_to_event_batch<&DamageSystem::on_collisions>(this);
+        // with void DamageSystem::on_collisions(EventSpan<CollisionBeginEvent> events)
         /////////////////////////////////////////////////////////////////////////////////////////////////
-        template <typename TEvent, typename TOwner>
-        void subscribe_to_event(TOwner* owner_instance, void (TOwner::*callback_function)(TEvent&)) {
-            if (!subscribers[typeid(TEvent)].get()) {
-                subscribers[typeid(TEvent)] = std::make_unique<HandlerList>();
+        template <auto Callback>
+        EventSubscription subscribe_to_event_batch(typename EventBatchCallbackTraits<decltype(Callback)>::Owner* owner_instance) {
+            using TEvent = typename EventBatchCallbackTraits<decltype(Callback)>::EventType;
+            EventSubscription subscription;
+            subscription.event_id = EventType<TEvent>::get_id();
+            subscription.id = next_subscription_id++;
+
+            get_handler_list(subscription.event_id).batch_handlers.push_back({subscription.id, owner_instance, &EventBus::batch_trampoline<Callback>});
+            return subscription;
+        }
+
+        // removes a single handler, safe to call from inside a handler of the same event
+        void unsubscribe(const EventSubscription& subscription) {
+            if (subscription.event_id < 0 || subscription.event_id >= static_cast<int>(subscribers.size())) {
+                return;
+            }
+            HandlerList& list = subscribers[subscription.event_id];
+            auto remove = [&](auto& handlers) {
+                for (auto it = handlers.begin(); it != handlers.end(); ++it) {
+                    if (it->id != subscription.id) {
+                        continue;
+                    }
+                    if (list.dispatch_depth > 0) {
+                        it->callback_function = nullptr;
+                        list.has_removed = true;
+                    } else {
+                        handlers.erase(it);
+                    }
+                    return true;
+                }
+                return false;
+            };
+            if (!remove(list.handlers)) {
+                remove(list.batch_handlers);
             }
-            auto subscriber = std::make_unique<EventCallback<TOwner, TEvent>>(owner_instance, callback_function);
-            subscribers[typeid(TEvent)]->push_back(std::move(subscriber));
         }
 
         /////////////////////////////////////////////////////////////////////////////////////////////////
         // emit event type <T>
         // in our implementation, an event is emitted by calling the emit_event function
         // the emit_event function is a member function of the event
-        // Example EventBus->EmitEvent<CollisionEvent>(player, enemy);
+        // Example event_bus->emit_event<CollisionBeginEvent>(player, enemy);
         /////////////////////////////////////////////////////////////////////////////////////////////////
         template <typename TEvent, typename... TArgs>
         void emit_event(TArgs&&... args) {
-            auto handlers = subscribers[typeid(TEvent)].get();
-            if (handlers) {
-                for (auto it = handlers->begin(); it != handlers->end(); ++it) {
-                    auto handler = it->get();
-                    TEvent event(std::forward<TArgs>(args)...);
-                    handler->Execute(event);
+            const int event_id = EventType<TEvent>::get_id();
+            if (event_id >= static_cast<int>(subscribers.size()) || subscribers[event_id].handlers.empty()) {
+                return;
+            }
+            TEvent event(std::forward<TArgs>(args)...);
+            begin_dispatch(event_id);
+            dispatch(event_id, event);
+            end_dispatch(event_id);
+        }
+
+        /////////////////////////////////////////////////////////////////////////////////////////////////
+        // queue event type <T>
+        // the event is stored in this frame's arena and handed to the handlers at the next
+        // dispatch_queued(), so the emitting loop is not interleaved with handler work
+        // Example event_bus->queue_event<CollisionBeginEvent>(player, enemy);
+        /////////////////////////////////////////////////////////////////////////////////////////////////
+        template <typename TEvent, typename... TArgs>
+        void queue_event(TArgs&&... args) {
+            static_assert(std::is_trivially_copyable<TEvent>::value && std::is_trivially_destructible<TEvent>::value,
+                "queued events are copied around and never destroyed, they must be plain data");
+
+            const int event_id = EventType<TEvent>::get_id();
+            unsigned char* slot = grow_queue(event_id, sizeof(TEvent), alignof(TEvent));
+            queues[event_id].deliver = &EventBus::deliver_queued<TEvent>;
+            new (slot) TEvent(std::forward<TArgs>(args)...);
+        }
+
+        // number of worker lanes, call before any thread queues into them, normally the thread pool size
+        void set_thread_count(size_t thread_count) {
+            lanes.resize(thread_count);
+        }
+
+        // cap on the events one lane holds per type between sync points, extra events are dropped and reported
+        void set_max_events_per_lane(size_t max_events) {
+            max_events_per_lane = max_events;
+        }
+
+        /////////////////////////////////////////////////////////////////////////////////////////////////
+        // queue event type <T> from a worker thread
+        // lock free, every thread writes only to its own lane. at dispatch_queued() the lanes are merged
+        // in order_key order (ties keep lane then emission order), so give each job a key that doesn't
+        // depend on scheduling, such as the index of the item that produced the event
+        // Example event_bus->queue_event_from_thread<CollisionBeginEvent>(thread_index, pair_key, a, b);
+        /////////////////////////////////////////////////////////////////////////////////////////////////
+        template <typename TEvent, typename... TArgs>
+        void queue_event_from_thread(size_t thread_index, uint64_t order_key, TArgs&&... args) {
+            static_assert(std::is_trivially_copyable<TEvent>::value && std::is_trivially_destructible<TEvent>::value,
+                "queued events are copied around and never destroyed, they must be plain data");
+
+            const int event_id = EventType<TEvent>::get_id();
+            EventLane& lane = lanes[thread_index];
+            if (event_id >= static_cast<int>(lane.queues.size())) {
+                lane.queues.resize(event_id + 1);
+            }
+            EventLaneQueue& queue = lane.queues[event_id];
+            if (queue.size == max_events_per_lane) {
+                queue.dropped++;
+                return;
+            }
+            if (queue.size == queue.order_keys.size()) {
+                // grows geometrically up to the cap, then the storage is reused frame after frame
+                size_t capacity = std::min(max_events_per_lane, std::max<size_t>(64, queue.size * 2));
+                queue.data.resize(capacity * sizeof(TEvent));
+                queue.order_keys.resize(capacity);
+                queue.element_size = sizeof(TEvent);
+                queue.alignment = alignof(TEvent);
+                queue.deliver = &EventBus::deliver_queued<TEvent>;
+            }
+            TEvent event(std::forward<TArgs>(args)...);
+            std::memcpy(queue.data.data() + queue.size * sizeof(TEvent), &event, sizeof(TEvent));
+            queue.order_keys[queue.size] = order_key;
+            queue.size++;
+        }
+
+        // sync point, delivers every queued event type by type in event id order, then frees the arena
+        // events queued by the handlers themselves are delivered in the same call
+        void dispatch_queued() {
+            if (is_dispatching_queued) {
+                return;
+            }
+            PROFILE_SCOPE("EventBus::dispatch_queued");
+            is_dispatching_queued = true;
+            merge_lanes();
+
+            bool has_pending = true;
+            while (has_pending) {
+                has_pending = false;
+                for (size_t event_id = 0; event_id < queues.size(); event_id++) {
+                    EventQueue& queue = queues[event_id];
+                    if (queue.delivered == queue.size) {
+                        continue;
+                    }
+                    size_t start = queue.delivered;
+                    size_t count = queue.size - start;
+                    queue.delivered = queue.size;
+                    has_pending = true;
+                    // deliver may queue more events and grow queues, don't touch queue after it
+                    queue.deliver(*this, static_cast<int>(event_id), queue.data, start, count);
                 }
             }
+
+            for (auto& queue : queues) {
+                queue = EventQueue();
+            }
+            arena.reset();
+            is_dispatching_queued = false;
         }
 };
 
 #endif
-
@@ -0,0 +1,12 @@
+#ifndef COLLISION_BEGIN_EVENT_H
+#define COLLISION_BEGIN_EVENT_H
+
+#include "collision_event.h"
+
+// Emitted once, on the first frame two colliders start overlapping
+class CollisionBeginEvent: public CollisionEvent {
+    public:
+        CollisionBeginEvent(Entity a, Entity b): CollisionEvent(a, b) {}
+};
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef COLLISION_END_EVENT_H
+#define COLLISION_END_EVENT_H
+
+#include "collision_event.h"
+
+// Emitted once, on the first frame two colliders stop overlapping
+class CollisionEndEvent: public CollisionEvent {
+    public:
+        CollisionEndEvent(Entity a, Entity b): CollisionEvent(a, b) {}
+};
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef COLLISION_STAY_EVENT_H
+#define COLLISION_STAY_EVENT_H
+
+#include "collision_event.h"
+
+// Emitted every "stay_interval" frames while two colliders keep overlapping
+class CollisionStayEvent: public CollisionEvent {
+    public:
+        CollisionStayEvent(Entity a, Entity b): CollisionEvent(a, b) {}
+};
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef TILE_COLLISION_EVENT_H
+#define TILE_COLLISION_EVENT_H
+
+#include "../ecs/ecs.h"
+#include "../event_bus/event.h"
+
+// Emitted once, on the frame a moving collider starts overlapping a solid map tile
+class TileCollisionEvent: public Event {
+    public:
+        Entity entity;
+        int column;
+        int row;
+        TileCollisionEvent(Entity entity, int column, int row): entity(entity), column(column), row(row) {}
+};
+
+#endif
@@ -0,0 +1,158 @@
+#include "fog_grid.h"
+#include "../logger/logger.h"
+#include <algorithm>
+#include <cmath>
+
+// the overlay is the clear color, fully opaque where nothing has been seen
+// and see-through enough where the scenery has been seen but is out of range
+static const uint32_t FOG_RGB = 0x040404;
+static const uint32_t UNREVEALED_PIXEL = (255u << 24) | FOG_RGB;
+static const uint32_t REVEALED_PIXEL = (155u << 24) | FOG_RGB;
+static const uint32_t VISIBLE_PIXEL = 0;
+
+FogGrid::FogGrid(int cell_size) {
+    this->cell_size = std::max(cell_size, 1);
+}
+
+FogGrid::~FogGrid() {
+    invalidate();
+}
+
+void FogGrid::invalidate() {
+    if (overlay) {
+        SDL_DestroyTexture(overlay);
+        overlay = nullptr;
+    }
+    dirty = {0, 0, columns, rows};
+}
+
+void FogGrid::resize(int map_width, int map_height) {
+    invalidate();
+    columns = std::max((map_width + cell_size - 1) / cell_size, 0);
+    rows = std::max((map_height + cell_size - 1) / cell_size, 0);
+    revealed.assign((columns * rows + 63) / 64, 0);
+    visible.assign(columns * rows, 0);
+    pixels.assign(columns * rows, UNREVEALED_PIXEL);
+    center_column = -1;
+    center_row = -1;
+    current_radius = -1;
+    visible_area = {0, 0, 0, 0};
+    dirty = {0, 0, columns, rows};
+}
+
+int FogGrid::cell_of(float position, int count) const {
+    int cell = static_cast<int>(std::floor(position / cell_size));
+    return std::min(std::max(cell, 0), count - 1);
+}
+
+void FogGrid::set_cell(int column, int row, bool is_visible) {
+    int index = row * columns + column;
+    visible[index] = is_visible;
+    if (is_visible) {
+        revealed[index >> 6] |= uint64_t(1) << (index & 63);
+    }
+    pixels[index] = is_visible ? VISIBLE_PIXEL : (is_cell_revealed(index) ? REVEALED_PIXEL : UNREVEALED_PIXEL);
+}
+
+void FogGrid::mark_dirty(const SDL_Rect& area) {
+    if (area.w <= 0 || area.h <= 0) {
+        return;
+    }
+    if (dirty.w <= 0 || dirty.h <= 0) {
+        dirty = area;
+        return;
+    }
+    SDL_Rect merged;
+    SDL_UnionRect(&dirty, &area, &merged);
+    dirty = merged;
+}
+
+bool FogGrid::update(float x, float y, int radius) {
+    if (columns == 0 || rows == 0) {
+        return false;
+    }
+    int column = cell_of(x, columns);
+    int row = cell_of(y, rows);
+    if (column == center_column && row == center_row && radius == current_radius) {
+        return false;
+    }
+
+    // everything inside the old circle goes back to fog first
+    for (int r = visible_area.y; r < visible_area.y + visible_area.h; r++) {
+        for (int c = visible_area.x; c < visible_area.x + visible_area.w; c++) {
+            set_cell(c, r, false);
+        }
+    }
+    mark_dirty(visible_area);
+
+    // cells whose center is inside the circle around the player's cell center
+    int reach = (std::max(radius, 0) + cell_size - 1) / cell_size;
+    int first_column = std::max(column - reach, 0);
+    int last_column = std::min(column + reach, columns - 1);
+    int first_row = std::max(row - reach, 0);
+    int last_row = std::min(row + reach, rows - 1);
+    long long radius_squared = static_cast<long long>(radius) * radius;
+    for (int r = first_row; r <= last_row; r++) {
+        long long dy = static_cast<long long>(r - row) * cell_size;
+        for (int c = first_column; c <= last_column; c++) {
+            long long dx = static_cast<long long>(c - column) * cell_size;
+            if (dx * dx + dy * dy <= radius_squared) {
+                set_cell(c, r, true);
+            }
+        }
+    }
+    visible_area = {first_column, first_row, last_column - first_column + 1, last_row - first_row + 1};
+    mark_dirty(visible_area);
+
+    center_column = column;
+    center_row = row;
+    current_radius = radius;
+    return true;
+}
+
+bool FogGrid::is_visible(float x, float y) const {
+    if (x < 0 || y < 0) {
+        return false;
+    }
+    int column = static_cast<int>(x) / cell_size;
+    int row = static_cast<int>(y) / cell_size;
+    if (column >= columns || row >= rows) {
+        return false;
+    }
+    return visible[row * columns + column];
+}
+
+bool FogGrid::is_revealed(float x, float y) const {
+    if (x < 0 || y < 0) {
+        return false;
+    }
+    int column = static_cast<int>(x) / cell_size;
+    int row = static_cast<int>(y) / cell_size;
+    if (column >= columns || row >= rows) {
+        return false;
+    }
+    return is_cell_revealed(row * columns + column);
+}
+
+void FogGrid::Render(SDL_Renderer* renderer, const SDL_Rect& camera) {
+    if (columns == 0 || rows == 0) {
+        return;
+    }
+    if (!overlay) {
+        overlay = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, columns, rows);
+        if (!overlay) {
+            Logger::Err("Failed to create fog of war overlay: " + std::string(SDL_GetError()));
+            return;
+        }
+        SDL_SetTextureBlendMode(overlay, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureScaleMode(overlay, SDL_ScaleModeLinear);
+        dirty = {0, 0, columns, rows};
+    }
+    if (dirty.w > 0 && dirty.h > 0) {
+        SDL_UpdateTexture(overlay, &dirty, &pixels[dirty.y * columns + dirty.x], columns * sizeof(uint32_t));
+        dirty = {0, 0, 0, 0};
+    }
+
+    SDL_Rect dst_rect = {-camera.x, -camera.y, columns * cell_size, rows * cell_size};
+    SDL_RenderCopy(renderer, overlay, NULL, &dst_rect);
+}
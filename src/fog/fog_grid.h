@@ -0,0 +1,80 @@
+#ifndef FOG_GRID_H
+#define FOG_GRID_H
+
+#include <cstdint>
+#include <vector>
+#include <SDL2/SDL.h>
+
+///////////////////////////
+// Fog Grid
+///////////////////////////
+// Fog of war as a coarse grid over the map. Each cell has a revealed bit,
+// set once the player has been near it, and a visibility byte, set while it
+// is inside the reveal radius. The radius is measured from the center of
+// the player's cell, so nothing changes until the player crosses into
+// another cell. Then only the cells around the old and new circles are
+// rewritten.
+// The grid is drawn as one overlay texture with a pixel per cell, stretched
+// over the map with linear filtering so the edge of the fog is soft. Only
+// the rows and columns that changed are uploaded again.
+///////////////////////////
+
+class FogGrid {
+    private:
+        int cell_size;
+        int columns = 0;
+        int rows = 0;
+        std::vector<uint64_t> revealed;
+        std::vector<uint8_t> visible;
+
+        // where the circle was last computed, -1 until the first update
+        int center_column = -1;
+        int center_row = -1;
+        int current_radius = -1;
+        // cells covered by the current circle's bounding box
+        SDL_Rect visible_area = {0, 0, 0, 0};
+
+        // one ARGB pixel per cell, the rectangle of cells not uploaded yet
+        SDL_Texture* overlay = nullptr;
+        std::vector<uint32_t> pixels;
+        SDL_Rect dirty = {0, 0, 0, 0};
+
+        bool is_cell_revealed(int index) const {
+            return (revealed[index >> 6] >> (index & 63)) & 1;
+        }
+        void set_cell(int column, int row, bool is_visible);
+        void mark_dirty(const SDL_Rect& area);
+        int cell_of(float position, int count) const;
+
+    public:
+        FogGrid(int cell_size = 32);
+        ~FogGrid();
+
+        // covers the map with fresh, unrevealed cells
+        void resize(int map_width, int map_height);
+
+        // moves the reveal circle, false when the player is still in the same cell and nothing changed
+        bool update(float x, float y, int radius);
+
+        // world position lookups, outside the map counts as fogged
+        bool is_visible(float x, float y) const;
+        bool is_revealed(float x, float y) const;
+
+        void Render(SDL_Renderer* renderer, const SDL_Rect& camera);
+        // drops the overlay texture, it is rebuilt from the grid on the next render
+        void invalidate();
+
+        int get_cell_size() const { return cell_size; }
+        // cells around the current reveal circle, in cells
+        const SDL_Rect& get_visible_area() const { return visible_area; }
+        // the cell the reveal circle is centered on, -1 before the first update
+        int get_center_column() const { return center_column; }
+        int get_center_row() const { return center_row; }
+        bool is_cell_visible(int column, int row) const {
+            return visible[row * columns + column];
+        }
+        int get_columns() const { return columns; }
+        int get_rows() const { return rows; }
+};
+
+#endif
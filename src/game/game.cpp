@@ -15,6 +15,10 @@
 #include "../systems/fog_of_war_system.h"
 #include "../systems/radar_system.h"
 #include "../systems/audio_system.h"
+#include "../systems/spatial_index_system.h"
+#include "../systems/state_hash_system.h"
+#include "../systems/interpolation_system.h"
+#include "../systems/hit_flash_system.h"
 
 // Others
 #include "../utils/utils.h"
@@ -22,7 +26,11 @@
 #include "game.h"
 #include "../logger/logger.h"
 #include "level_loader.h"
+#include "../timing/clock.h"
+#include "../profiler/profiler.h"
 #include <iostream>
+#include <cmath>
+#include <ctime>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
@@ -45,6 +53,10 @@ Game::Game() {
     registry = std::make_unique<Registry>();
     asset_store = std::make_unique<AssetStore>();
     event_bus = std::make_unique<EventBus>();
+    tile_map = std::make_unique<TileMap>();
+    tile_map_renderer = std::make_unique<TileMapRenderer>();
+    debug_draw = std::make_unique<DebugDraw>();
+    frame_pacer = std::make_unique<FramePacer>();
     lua.open_libraries(sol::lib::base, sol::lib::os, sol::lib::math);
     
     Logger::Log("Game constructor called.");
@@ -54,25 +66,29 @@ Game::~Game() {
     Logger::Log("Game destructor called.");
 }
 
-void Game::Initialize(void) {
-    
-    if (SDL_Init(SDL_INIT_EVERYTHING != 0)) {
-        Logger::Err("Error initializing SDL.");
-        return;
-    }
+void Game::set_headless(int ticks) {
+    is_headless = true;
+    headless_ticks = ticks;
+}
 
-    if (TTF_Init() != 0) {
-        Logger::Err("Error initializing SDL TTF.");
-        return;
-    }
+void Game::set_recording(const std::string& file_path) {
+    record_file = file_path;
+}
 
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        Logger::Err("Error initializing SDL Mixer.");
-        return;
-    }
+void Game::set_replay(const std::string& file_path) {
+    replay_file = file_path;
+}
+
+void Game::set_seed(uint32_t seed) {
+    random_seed = seed;
+    has_random_seed = true;
+}
 
-    Mix_AllocateChannels(5);
+void Game::set_trace_at_frame(int frame) {
+    trace_at_frame = frame;
+}
 
+void Game::Initialize(void) {
     bool full_screen = false;
     std::string config_file = "./assets/scripts/constants.lua";
     sol::load_result script = lua.load_file(config_file);
@@ -89,9 +105,80 @@ void Game::Initialize(void) {
         full_screen = config["full_screen"];
         is_debug = config["debug"];
         fps = config["target_fps"];
-        ms_per_frame = 1000 / fps;
+        vsync = config["vsync"].get_or(false);
+        // vsync and the pacer would both wait, every frame ending on whichever is later
+        frame_pacer->set_target_fps(vsync ? 0 : fps);
+        double simulation_rate = config["simulation_rate"].get_or(60.0);
+        fixed_delta_time = 1.0 / (simulation_rate > 0 ? simulation_rate : 60.0);
+        max_simulation_steps = config["max_simulation_steps"].get_or(5);
+        collision_stay_interval = config["collision_stay_interval"].get_or(0);
+        worker_threads = config["worker_threads"].get_or(-1);
+        text_cache_budget_kb = config["text_cache_budget_kb"].get_or(4096);
+        fog_cell_size = config["fog_cell_size"].get_or(32);
+        radar_refresh_rate = config["radar_refresh_rate"].get_or(10);
+        debug_font = config["debug_font"].get_or(std::string("pico8-font-10"));
         verbose_logging = config["verbose_logging"];
         Logger::debug_to_console = config["debug_to_console"];
+        // the command line wins over the config
+        if (!is_headless && config["headless"].get_or(false)) {
+            set_headless(config["headless_ticks"].get_or(0));
+        }
+        if (record_file.empty()) {
+            record_file = config["record_input"].get_or(std::string(""));
+        }
+        if (replay_file.empty()) {
+            replay_file = config["replay_input"].get_or(std::string(""));
+        }
+        if (!has_random_seed) {
+            random_seed = config["random_seed"].get_or(1);
+        }
+        trace_file = config["trace_file"].get_or(std::string("trace.json"));
+        trace_frames = config["trace_frames"].get_or(300);
+        allocation_report = config["allocation_report"].get_or(std::string("allocations.txt"));
+        if (trace_at_frame < 0) {
+            trace_at_frame = config["trace_at_frame"].get_or(-1);
+        }
+    }
+
+    Profiler::set_thread_name("main");
+
+    // headless runs need neither a display nor an audio device
+    Uint32 sdl_flags = is_headless ? (SDL_INIT_TIMER | SDL_INIT_EVENTS) : SDL_INIT_EVERYTHING;
+    if (SDL_Init(sdl_flags) != 0) {
+        Logger::Err("Error initializing SDL.");
+        return;
+    }
+
+    if (TTF_Init() != 0) {
+        Logger::Err("Error initializing SDL TTF.");
+        return;
+    }
+
+    if (!is_headless) {
+        if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+            Logger::Err("Error initializing SDL Mixer.");
+            return;
+        }
+        Mix_AllocateChannels(5);
+    }
+
+    thread_pool = std::make_unique<ThreadPool>(worker_threads);
+    // one event lane per thread that can run a parallel_for job
+    event_bus->set_thread_count(thread_pool->get_thread_count());
+
+    if (is_headless) {
+        // a software renderer on a surface in memory, so the level's textures still load without a display,
+        // nothing is ever drawn with it
+        headless_surface = SDL_CreateRGBSurfaceWithFormat(0, window_width, window_height, 32, SDL_PIXELFORMAT_RGBA32);
+        renderer = headless_surface ? SDL_CreateSoftwareRenderer(headless_surface) : nullptr;
+        if (!renderer) {
+            Logger::Err("Error creating headless renderer.");
+            return;
+        }
+        camera = {0, 0, window_width, window_height};
+        is_running = true;
+        Logger::Log("Running headless" + (headless_ticks > 0 ? " for " + std::to_string(headless_ticks) + " ticks." : std::string(".")));
+        return;
     }
 
     // full screen
@@ -121,7 +208,7 @@ void Game::Initialize(void) {
     renderer = SDL_CreateRenderer(
         window,
         -1,
-        SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
+        SDL_RENDERER_ACCELERATED | (vsync ? SDL_RENDERER_PRESENTVSYNC : 0)
     );
     if (!renderer) {
         Logger::Err("Error creating SDL renderer.");
@@ -142,8 +229,17 @@ void Game::Initialize(void) {
 }
 
 void Game::ProcessInput(void) {
+    PROFILE_SCOPE("Game::ProcessInput");
     SDL_Event sdl_event;
     while (SDL_PollEvent(&sdl_event)) {
+        // no window, no ImGui, only a quit request (e.g. Ctrl+C) matters
+        if (is_headless) {
+            if (sdl_event.type == SDL_QUIT) {
+                is_running = false;
+            }
+            continue;
+        }
+
         // handle ImGui SDL events
         ImGui_ImplSDL2_ProcessEvent(&sdl_event);
         ImGuiIO& io = ImGui::GetIO();
@@ -168,18 +264,43 @@ void Game::ProcessInput(void) {
                     is_debug = !is_debug;
                     Logger::Log("Debug mode toggled. Debug mode is now " + std::string(is_debug ? "true" : "false") + ".");
                 }
+                if (sdl_event.key.keysym.sym == SDLK_F9) {
+                    Profiler::start_capture(trace_file, trace_frames);
+                }
+                if (sdl_event.key.keysym.sym == SDLK_F10 && AllocationTracker::is_enabled()) {
+                    Profiler::write_allocation_report(allocation_report);
+                }
+                // a replay plays the recorded keys from Update() instead, live keys only quit or toggle debug
+                if (input_replay) {
+                    break;
+                }
+                if (input_recorder) {
+                    input_recorder->record_key(tick, sdl_event.key.keysym.sym);
+                }
                 event_bus->emit_event<KeyPressedEvent>(sdl_event.key.keysym.sym);
                 break;
+            case SDL_RENDER_TARGETS_RESET:
+                // the cached tilemap chunks and the radar are render targets, their contents are gone
+                tile_map_renderer->invalidate();
+                registry->get_system<RadarSystem>().invalidate();
+                break;
+            case SDL_RENDER_DEVICE_RESET:
+                // every texture is gone, the cached text included
+                tile_map_renderer->invalidate();
+                registry->get_system<RenderTextSystem>().clear_cache();
+                registry->get_system<FogOfWarSystem>().invalidate();
+                registry->get_system<RadarSystem>().invalidate();
+                break;
         } 
     }
 }
 
 void Game::LoadSystems() {
     registry->add_system<RenderSystem>();
-    registry->add_system<RenderTextSystem>();
+    registry->add_system<RenderTextSystem>(static_cast<size_t>(text_cache_budget_kb) * 1024);
     registry->add_system<AudioSystem>();
     registry->add_system<MovementSystem>();
-    registry->add_system<CollisionSystem>();
+    registry->add_system<CollisionSystem>(collision_stay_interval);
     registry->add_system<AnimationSystem>();
     registry->add_system<DamageSystem>();
     registry->add_system<KeyboardControlSystem>();
@@ -189,92 +310,291 @@ void Game::LoadSystems() {
     registry->add_system<HealthBarSystem>();
     registry->add_system<RenderGUISystem>();
     registry->add_system<ScriptSystem>();
-    registry->add_system<FogOfWarSystem>();
-    registry->add_system<RadarSystem>();
+    registry->add_system<FogOfWarSystem>(fog_cell_size);
+    registry->add_system<RadarSystem>(radar_refresh_rate);
+    registry->add_system<SpatialIndexSystem>();
+    registry->add_system<StateHashSystem>();
+    registry->add_system<InterpolationSystem>();
+    registry->add_system<HitFlashSystem>();
+
+    // subscriptions live as long as the systems, no need to redo them every frame
+    registry->get_system<DamageSystem>().subscribe_to_events(event_bus);
+    registry->get_system<KeyboardControlSystem>().subscribe_to_events(event_bus);
+    registry->get_system<ProjectileEmitSystem>().subscribe_to_events(event_bus);
+    registry->get_system<MovementSystem>().subscribe_to_events(event_bus);
 }
 
 void Game::LuaBindings() {
-    registry->get_system<ScriptSystem>().CreateLuaBinds(lua);
+    registry->get_system<ScriptSystem>().CreateLuaBinds(lua, registry->get_system<SpatialIndexSystem>().get_index(), tile_map, asset_store);
 }
 
 void Game::Setup() {
 
     LoadSystems();
     LuaBindings();
+    // headless runs step faster than real time, emission, lifetimes, animation and scripts have to go by
+    // ticks too, Update() advances the clock one fixed step at a time
+    if (is_headless) {
+        Clock::use_simulated_time();
+    }
+    // before the level script runs, it may already read the time or draw random numbers
+    SetupDeterminism();
     LevelLoader loader;
-    loader.load_level(lua, registry, asset_store, renderer, 1);
+    loader.load_level(lua, registry, asset_store, tile_map, renderer, 1);
 }
 
-void Game::TimeDo() {
-    int time_to_wait = ms_per_frame - (SDL_GetTicks() - ms_prev_frame);
-    if (time_to_wait > 0 && time_to_wait <= ms_per_frame) {
-        SDL_Delay(time_to_wait);
+// Recording and replaying need the same run from the same input. The simulation clock is switched to
+// simulated time, Lua's random numbers get a fixed seed and os.time/os.date report the recorded start time
+// plus the simulated time, the level picks its tileset from the hour for one.
+void Game::SetupDeterminism() {
+    if (record_file.empty() && replay_file.empty()) {
+        return;
+    }
+    RecordingHeader header;
+    header.seed = random_seed;
+    header.start_time = static_cast<int64_t>(std::time(nullptr));
+    if (!replay_file.empty()) {
+        input_replay = std::make_unique<InputReplay>();
+        if (input_replay->load(replay_file)) {
+            header = input_replay->get_header();
+        } else {
+            input_replay.reset();
+        }
+    }
+    if (!record_file.empty()) {
+        // replaying into a new recording is allowed, it carries the seed and start time over
+        input_recorder = std::make_unique<InputRecorder>();
+        if (!input_recorder->open(record_file, header)) {
+            input_recorder.reset();
+        }
+    }
+    if (!input_replay && !input_recorder) {
+        return;
     }
-    delta_time = (SDL_GetTicks() - ms_prev_frame) / 1000.0f;
-    ms_prev_frame = SDL_GetTicks();
-}
 
-void Game::Update() {
-    TimeDo();
+    Clock::use_simulated_time();
+    lua["math"]["randomseed"](header.seed);
+    sol::function pin_time = lua.script(R"(
+        return function(start_time, get_ticks)
+            local wall_time, wall_date = os.time, os.date
+            os.time = function(date_table)
+                if date_table then
+                    return wall_time(date_table)
+                end
+                return start_time + get_ticks() // 1000
+            end
+            os.date = function(format, time)
+                return wall_date(format, time or os.time())
+            end
+        end
+    )");
+    pin_time(header.start_time, []() { return Clock::get_ticks(); });
+}
 
-    // reset all event handlers for the current frame
-    event_bus->reset();
+// holds the render rate at target_fps and adds the real time since the last frame to the simulation's budget
+void Game::TimeDo() {
+    accumulator += frame_pacer->wait();
+}
 
-    // subscribe to events
-    registry->get_system<DamageSystem>().subscribe_to_events(event_bus);
-    registry->get_system<KeyboardControlSystem>().subscribe_to_events(event_bus);
-    registry->get_system<ProjectileEmitSystem>().subscribe_to_events(event_bus);
-    registry->get_system<MovementSystem>().subscribe_to_events(event_bus);
+void Game::Update() {
+    PROFILE_SCOPE("Game::Update");
+    // where this step starts from, the renderer blends from here
+    previous_camera = camera;
+    float delta_time = static_cast<float>(fixed_delta_time);
+
+    // the keys recorded before this tick, handed over where live keys would have been
+    if (input_replay) {
+        replay_keys.clear();
+        input_replay->keys_at(tick, replay_keys);
+        for (SDL_Keycode key : replay_keys) {
+            event_bus->emit_event<KeyPressedEvent>(key);
+        }
+    }
 
      // update the registry to process any entities that are waiting to be added/removed
     registry->Update();
 
-    registry->get_system<AudioSystem>().Update(asset_store);
+    // the renderer blends from where everything is now
+    registry->get_system<InterpolationSystem>().Update();
+
+    // snapshot entity positions for this frame's proximity queries
+    registry->get_system<SpatialIndexSystem>().Update();
+
+    if (!is_headless) {
+        registry->get_system<AudioSystem>().Update(asset_store);
+    }
     registry->get_system<FogOfWarSystem>().Update(registry);
     registry->get_system<MovementSystem>().Update(delta_time, map_width, map_height);
     registry->get_system<AnimationSystem>().Update();
-    registry->get_system<CollisionSystem>().Update(event_bus, is_debug);
+    registry->get_system<HitFlashSystem>().Update();
+    registry->get_system<CollisionSystem>().Update(event_bus, thread_pool, tile_map, is_debug);
+    // collision events are queued during the scan, hand them to damage and movement in one go
+    event_bus->dispatch_queued();
     registry->get_system<ProjectileEmitSystem>().Update(registry);
     registry->get_system<CameraMovementSystem>().Update(camera, map_width, map_height);
     registry->get_system<ProjectileLifecycleSystem>().Update(camera);
     registry->get_system<HealthBarSystem>().Update();
-    registry->get_system<ScriptSystem>().Update(delta_time, SDL_GetTicks());
-
+    registry->get_system<ScriptSystem>().Update(delta_time, Clock::get_ticks());
+
+    if (input_recorder || input_replay) {
+        uint64_t state_hash = registry->get_system<StateHashSystem>().compute();
+        if (input_recorder) {
+            input_recorder->record_state_hash(tick, state_hash);
+        }
+        if (input_replay) {
+            input_replay->check_state_hash(tick, state_hash);
+        }
+    }
+    tick++;
+    Clock::advance(fixed_delta_time);
+    if (input_replay && input_replay->is_finished(tick)) {
+        is_running = false;
+    }
 }
 
 void Game::Render() {
+    PROFILE_SCOPE("Game::Render");
     SDL_SetRenderDrawColor(renderer,4,4,4,255);
     SDL_RenderClear(renderer);
 
+    // the camera is blended like the sprites, so followed entities don't jitter against the map
+    SDL_Rect render_camera = camera;
+    render_camera.x = static_cast<int>(previous_camera.x + (camera.x - previous_camera.x) * interpolation);
+    render_camera.y = static_cast<int>(previous_camera.y + (camera.y - previous_camera.y) * interpolation);
+
+    // the map goes under everything else
+    tile_map_renderer->Render(renderer, *tile_map, *asset_store, render_camera);
+
     // invoke all of the systems that need to render
-    registry->get_system<RenderSystem>().Render(renderer, asset_store, camera);
-    registry->get_system<RenderTextSystem>().Render(renderer, asset_store, camera);
+    const FogGrid& fog = registry->get_system<FogOfWarSystem>().get_grid();
+    registry->get_system<RenderSystem>().Render(renderer, asset_store, render_camera, fog, interpolation);
+    registry->get_system<FogOfWarSystem>().Render(renderer, render_camera);
+    registry->get_system<RenderTextSystem>().Render(renderer, asset_store, render_camera, fog, interpolation);
 
     if (is_debug) {
-        registry->get_system<CollisionSystem>().ColliderDebug(renderer, camera);
-        registry->get_system<RenderGUISystem>().Render(registry, camera, map_width, map_height);
+        // every debug shape of the frame is recorded first and drawn in a few batched calls
+        debug_draw->begin(*asset_store, debug_font);
+        registry->get_system<CollisionSystem>().ColliderDebug(*debug_draw, render_camera);
+        registry->get_system<SpatialIndexSystem>().draw_debug(*debug_draw, render_camera);
+        registry->get_system<FogOfWarSystem>().draw_debug(*debug_draw, render_camera);
+        debug_draw->flush(renderer);
+        registry->get_system<RenderGUISystem>().Render(registry, camera, map_width, map_height, registry->get_system<RenderSystem>().get_render_stats(), registry->get_system<RenderTextSystem>().get_text_cache_stats(), frame_pacer->get_stats());
     }
-    registry->get_system<RadarSystem>().Render(renderer, registry);
+    registry->get_system<RadarSystem>().Render(renderer, registry, registry->get_system<SpatialIndexSystem>().get_index());
 
+    PROFILE_SCOPE("SDL_RenderPresent");
     SDL_RenderPresent(renderer);
 }
 
 void Game::Run() {
-    if (!window || !renderer) {
+    if (!renderer || (!window && !is_headless)) {
         Logger::Err("Error running game.");
         return;
     }
+    // loading the level is frame 0, a capture from frame 0 on has the asset loads in it
+    BeginFrame();
     Setup();
+    EndFrame();
+    if (is_headless) {
+        RunHeadless();
+        return;
+    }
+    previous_camera = camera;
+    frame_pacer->reset();
     while (is_running) {
+        BeginFrame();
         ProcessInput();
-        Update();
+        TimeDo();
+
+        // as many fixed steps as the real time since the last frame covers, the rest carries over
+        int steps = 0;
+        while (is_running && accumulator >= fixed_delta_time && steps < max_simulation_steps) {
+            Update();
+            accumulator -= fixed_delta_time;
+            steps++;
+        }
+        // too far behind to catch up, drop the backlog instead of running ever more steps per frame
+        if (accumulator >= fixed_delta_time) {
+            if (verbose_logging) {
+                Logger::Log("Simulation fell behind, skipped " + std::to_string(static_cast<int>(accumulator / fixed_delta_time)) + " steps.");
+            }
+            accumulator = std::fmod(accumulator, fixed_delta_time);
+        }
+        interpolation = static_cast<float>(accumulator / fixed_delta_time);
+
         Render();
+        PROFILE_COUNTER("draw calls", registry->get_system<RenderSystem>().get_render_stats().draw_calls);
+        EndFrame();
+    }
+}
+
+// brackets a frame for the profiler, a capture asked for at this frame starts here
+void Game::BeginFrame() {
+    Profiler::begin_frame();
+    if (frame_count == trace_at_frame) {
+        Profiler::start_capture(trace_file, trace_frames);
+    }
+}
+
+void Game::EndFrame() {
+    PROFILE_COUNTER("entities", registry->get_entity_count());
+    Profiler::end_frame();
+    frame_count++;
+}
+
+// steps the simulation back to back, as fast as it goes, without rendering or audio
+void Game::RunHeadless() {
+    Uint64 start = SDL_GetPerformanceCounter();
+    int ticks = 0;
+    while (is_running && (headless_ticks <= 0 || ticks < headless_ticks)) {
+        // a tick is a frame to the profiler
+        BeginFrame();
+        ProcessInput();
+        Update();
+        EndFrame();
+        ticks++;
     }
+    double seconds = (SDL_GetPerformanceCounter() - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+    Logger::Log("Headless run finished: " + std::to_string(ticks) + " ticks in " + std::to_string(seconds) + " s, " +
+        std::to_string(seconds > 0 ? static_cast<int>(ticks / seconds) : 0) + " ticks/s.");
 }
 
 void Game::Destroy() {
+    // a capture cut short by quitting still gets written
+    Profiler::finish_capture();
+    if (AllocationTracker::is_enabled()) {
+        Profiler::write_allocation_report(allocation_report);
+    }
+    if (input_recorder) {
+        input_recorder->close(tick);
+    }
+    if (input_replay) {
+        if (input_replay->get_divergent_tick() < 0) {
+            Logger::Log("Replay finished after " + std::to_string(tick) + " ticks, in sync with the recording.");
+        } else {
+            Logger::Err("Replay finished after " + std::to_string(tick) + " ticks, diverged at tick " + std::to_string(input_replay->get_divergent_tick()) + ".");
+        }
+    }
+    if (is_headless) {
+        // the atlas pages are freed with the asset store, the renderer only has to outlive them until then
+        asset_store->clear_assets();
+        if (renderer) {
+            SDL_DestroyRenderer(renderer);
+        }
+        if (headless_surface) {
+            SDL_FreeSurface(headless_surface);
+        }
+        TTF_Quit();
+        SDL_Quit();
+        return;
+    }
     ImGuiSDL::Deinitialize();
     ImGui::DestroyContext();
+    // the cached map chunks, text, fog and radar textures belong to the renderer
+    tile_map_renderer->invalidate();
+    registry->get_system<RenderTextSystem>().clear_cache();
+    registry->get_system<FogOfWarSystem>().invalidate();
+    registry->get_system<RadarSystem>().invalidate();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
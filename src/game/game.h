@@ -7,6 +7,12 @@
 #include "../asset_store/asset_store.h"
 #include "../components/sprite_component.h"
 #include "../event_bus/event_bus.h"
+#include "../jobs/thread_pool.h"
+#include "../tilemap/tile_map.h"
+#include "../tilemap/tile_map_renderer.h"
+#include "../debug/debug_draw.h"
+#include "../timing/frame_pacer.h"
+#include "../input/input_recording.h"
 
 // const int FPS = 60;
 // const int MS_PER_FRAME = 1000 / FPS;
@@ -14,35 +20,82 @@
 class Game {
     private:
         bool is_running;
-        int ms_prev_frame = 0;
-        float delta_time = 0;
+        // fixed rate simulation, Update() runs every fixed_delta_time seconds of real time
+        double fixed_delta_time = 1.0 / 60.0;
+        int max_simulation_steps = 5;
+        double accumulator = 0;
+        // how far the rendered frame is between the last two simulation steps, 0 to 1
+        float interpolation = 1.0f;
+        SDL_Rect previous_camera;
         bool is_debug = false;
         int fps = 0;
-        int ms_per_frame = 0;
+        // present on the display refresh, the frame pacer then only measures
+        bool vsync = false;
+        int collision_stay_interval = 0;
+        int worker_threads = -1;
+        int text_cache_budget_kb = 4096;
+        int fog_cell_size = 32;
+        int radar_refresh_rate = 10;
+        std::string debug_font = "pico8-font-10";
 
-        SDL_Window* window;
-        SDL_Renderer* renderer;
+        SDL_Window* window = nullptr;
+        SDL_Renderer* renderer = nullptr;
+        // no window, no audio, no ImGui, Update() back to back for headless_ticks ticks, 0 runs until quit
+        bool is_headless = false;
+        int headless_ticks = 0;
+        SDL_Surface* headless_surface = nullptr;
+        // recorded and replayed runs step the simulation on simulated time with a fixed seed
+        std::string record_file;
+        std::string replay_file;
+        uint32_t random_seed = 1;
+        bool has_random_seed = false;
+        // Update() calls so far, the time base of the recordings
+        uint32_t tick = 0;
+        std::vector<SDL_Keycode> replay_keys;
+        // profiler trace captures, F9 or automatically at trace_at_frame
+        std::string trace_file = "trace.json";
+        int trace_frames = 300;
+        int trace_at_frame = -1;
+        int frame_count = 0;
+        std::string allocation_report = "allocations.txt";
         SDL_Rect camera;
 
         sol::state lua;
         std::unique_ptr<Registry> registry;
         std::unique_ptr<AssetStore> asset_store;
         std::unique_ptr<EventBus> event_bus;
+        std::unique_ptr<ThreadPool> thread_pool;
+        std::unique_ptr<TileMap> tile_map;
+        std::unique_ptr<TileMapRenderer> tile_map_renderer;
+        std::unique_ptr<DebugDraw> debug_draw;
+        std::unique_ptr<FramePacer> frame_pacer;
+        std::unique_ptr<InputRecorder> input_recorder;
+        std::unique_ptr<InputReplay> input_replay;
 
     public:
         Game();
         ~Game();
 
+        // call before Initialize()
+        void set_headless(int ticks = 0);
+        void set_recording(const std::string& file_path);
+        void set_replay(const std::string& file_path);
+        void set_seed(uint32_t seed);
+        void set_trace_at_frame(int frame);
         void Initialize();
         void Run();
+        void RunHeadless();
         void LoadSystems();
         void LuaBindings();
         void Setup();
+        void SetupDeterminism();
         void ProcessInput();
         void Update();
         void Render();
         void Destroy();
         void TimeDo();
+        void BeginFrame();
+        void EndFrame();
 
         static bool verbose_logging;
         static int set_radius;
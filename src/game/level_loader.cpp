@@ -11,6 +11,7 @@
 #include "../ecs/ecs.h"
 #include "../utils/utils.h"
 #include "../logger/logger.h"
+#include "../profiler/profile_scope.h"
 
 #include "../asset_store/asset_store.h"
 #include "../components/transform_component.h"
@@ -35,7 +36,7 @@ LevelLoader::~LevelLoader() {
     Logger::Log("LevelLoader destructor called!");
 }
 
-void LevelLoader::LoadTileMap(const std::unique_ptr<Registry>& registry, std::string asset_id, std::string file_path, int tile_size, int tile_scale) {
+void LevelLoader::LoadTileMap(const std::unique_ptr<TileMap>& tile_map, const std::unique_ptr<AssetStore>& asset_store, std::string asset_id, std::string file_path, int tile_size, int tile_scale, const std::vector<int>& solid_tiles) {
     std::vector<std::vector<int>> tile_data;
     int scale = tile_size * tile_scale;
 
@@ -50,32 +51,22 @@ void LevelLoader::LoadTileMap(const std::unique_ptr<Registry>& registry, std::st
         }
         tile_data.push_back(row);
     }
+    if (tile_data.empty()) {
+        Logger::Err("Tilemap file is empty or missing: " + file_path);
+        return;
+    }
 
     Game::map_width = tile_data[0].size() * scale;
     Game::map_height = tile_data.size() * scale;
-    
-    for (int y = 0; y < tile_data.size(); ++y) {
-        for (int x = 0; x < tile_data[y].size(); ++x) {
-            int tile_id = tile_data[y][x]; 
-
-            SDL_Rect src_rect;
-            int tile_row = tile_id / 10; 
-            int tile_col = tile_id % 10;
 
-            src_rect.x = tile_col * tile_size;
-            src_rect.y = tile_row * tile_size;
-            src_rect.w = tile_size;
-            src_rect.h = tile_size;
-
-            Entity tile_entity = registry->create_entity();
-            tile_entity.Group("tiles");
-            tile_entity.add_component<TransformComponent>(glm::vec2(x * (scale), y * (scale)), glm::vec2(tile_scale, tile_scale), 0.0);
-            tile_entity.add_component<SpriteComponent>(asset_id, tile_size, tile_size, BACKGROUND_LAYER, src_rect.x, src_rect.y);
-        }
-    }
+    // the tiles are drawn by TileMapRenderer straight from the tile map, they are not entities,
+    // and blocking terrain lives in the same grid instead of in collider entities
+    tile_map->load(tile_data, scale, solid_tiles);
+    tile_map->set_tileset(asset_store->get_texture_handle(asset_id), tile_size);
 }
 
-void LevelLoader::load_level(sol::state& lua, const std::unique_ptr<Registry>& registry, const std::unique_ptr<AssetStore>& asset_store, SDL_Renderer* renderer, int level_number) {
+void LevelLoader::load_level(sol::state& lua, const std::unique_ptr<Registry>& registry, const std::unique_ptr<AssetStore>& asset_store, const std::unique_ptr<TileMap>& tile_map, SDL_Renderer* renderer, int level_number) {
+    PROFILE_SCOPE("LevelLoader::load_level");
 
     std::string level_file = "./assets/scripts/Level" + std::to_string(level_number) + ".lua";
     sol::load_result script = lua.load_file(level_file);
@@ -112,6 +103,8 @@ void LevelLoader::load_level(sol::state& lua, const std::unique_ptr<Registry>& r
         }
         i++;
     }
+    // pack the level's textures into atlas pages, so sprites from different sheets can share a draw call
+    asset_store->build_atlases(renderer);
 
     // Load tilemap
     sol::table tilemap = level["tilemap"];
@@ -119,7 +112,20 @@ void LevelLoader::load_level(sol::state& lua, const std::unique_ptr<Registry>& r
     std::string texture_asset_id = tilemap["texture_asset_id"];
     int tile_size = tilemap["tile_size"];
     float scale = tilemap["scale"];
-    LoadTileMap(registry, texture_asset_id, map_file, tile_size, scale);
+
+    // ids of the tiles that block movement, walls, water, etc.
+    std::vector<int> solid_tiles;
+    sol::optional<sol::table> solid_tiles_table = tilemap["solid_tiles"];
+    if (solid_tiles_table != sol::nullopt) {
+        for (int j = 1; ; j++) {
+            sol::optional<int> tile_id = solid_tiles_table.value()[j];
+            if (tile_id == sol::nullopt) {
+                break;
+            }
+            solid_tiles.push_back(tile_id.value());
+        }
+    }
+    LoadTileMap(tile_map, asset_store, texture_asset_id, map_file, tile_size, scale, solid_tiles);
     if (Game::verbose_logging) {
         Logger::Log("Loaded tilemap for level " + std::to_string(level_number)+ "!");
     }
@@ -290,14 +296,4 @@ void LevelLoader::load_level(sol::state& lua, const std::unique_ptr<Registry>& r
         i++;  
             
     }
-
-    // Entity blocking = registry->create_entity();
-    // blocking.Group("obstacles");
-    // blocking.add_component<TransformComponent>(glm::vec2(900.0, 500.0), glm::vec2(2.0, 2.0), 0.0);
-    // blocking.add_component<BoxColliderComponent>(16, 200, glm::vec2(0.0, 0.0));
-
-    // Entity blocking2 = registry->create_entity();
-    // blocking2.Group("obstacles");
-    // blocking2.add_component<TransformComponent>(glm::vec2(500.0, 500.0), glm::vec2(2.0, 2.0), 0.0);
-    // blocking2.add_component<BoxColliderComponent>(16, 200, glm::vec2(0.0, 0.0));
 }
\ No newline at end of file
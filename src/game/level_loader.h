@@ -5,14 +5,15 @@
 #include <sol/sol.hpp>
 #include "../ecs/ecs.h"
 #include "../asset_store/asset_store.h"
+#include "../tilemap/tile_map.h"
 
 class LevelLoader {
     public:
         LevelLoader();
         ~LevelLoader();
 
-        void LoadTileMap(const std::unique_ptr<Registry>& registry, std::string asset_id, std::string file_path, int tile_size, int tile_scale);
-        void load_level(sol::state& lua, const std::unique_ptr<Registry>& registry, const std::unique_ptr<AssetStore>& asset_store, SDL_Renderer* renderer, int level_number);
+        void LoadTileMap(const std::unique_ptr<TileMap>& tile_map, const std::unique_ptr<AssetStore>& asset_store, std::string asset_id, std::string file_path, int tile_size, int tile_scale, const std::vector<int>& solid_tiles);
+        void load_level(sol::state& lua, const std::unique_ptr<Registry>& registry, const std::unique_ptr<AssetStore>& asset_store, const std::unique_ptr<TileMap>& tile_map, SDL_Renderer* renderer, int level_number);
 };
 
 #endif
\ No newline at end of file
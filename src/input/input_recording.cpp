@@ -0,0 +1,173 @@
+#include "input_recording.h"
+#include "../logger/logger.h"
+#include <cstring>
+
+namespace {
+    const char MAGIC[4] = {'R', 'P', 'L', 'Y'};
+    const uint32_t VERSION = 1;
+
+    void put(std::vector<unsigned char>& buffer, uint64_t value, int size) {
+        for (int i = 0; i < size; i++) {
+            buffer.push_back(static_cast<unsigned char>(value >> (8 * i)));
+        }
+    }
+
+    uint64_t get(const std::vector<unsigned char>& data, size_t offset, int size) {
+        uint64_t value = 0;
+        for (int i = 0; i < size; i++) {
+            value |= static_cast<uint64_t>(data[offset + i]) << (8 * i);
+        }
+        return value;
+    }
+}
+
+///////////////////////////
+// InputRecorder
+///////////////////////////
+
+InputRecorder::~InputRecorder() {
+    // a run that ended without close() still keeps what was recorded, it just has no end marker
+    flush();
+}
+
+bool InputRecorder::open(const std::string& file_path, const RecordingHeader& header) {
+    file.open(file_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        Logger::Err("Failed to open input recording for writing: " + file_path);
+        return false;
+    }
+    buffer.insert(buffer.end(), MAGIC, MAGIC + sizeof(MAGIC));
+    put(buffer, VERSION, 4);
+    put(buffer, header.seed, 4);
+    put(buffer, static_cast<uint64_t>(header.start_time), 8);
+    flush();
+    Logger::Log("Recording input to " + file_path + ", seed " + std::to_string(header.seed) + ".");
+    return true;
+}
+
+void InputRecorder::write_record(uint32_t tick, RecordType type) {
+    put(buffer, tick, 4);
+    buffer.push_back(type);
+}
+
+void InputRecorder::record_key(uint32_t tick, SDL_Keycode key) {
+    if (!file.is_open()) {
+        return;
+    }
+    write_record(tick, RECORD_KEY_DOWN);
+    put(buffer, static_cast<uint32_t>(key), 4);
+}
+
+void InputRecorder::record_state_hash(uint32_t tick, uint64_t hash) {
+    if (!file.is_open()) {
+        return;
+    }
+    write_record(tick, RECORD_STATE_HASH);
+    put(buffer, hash, 8);
+    // written in blocks, not a syscall per tick
+    if (buffer.size() >= 4096) {
+        flush();
+    }
+}
+
+void InputRecorder::close(uint32_t tick) {
+    if (!file.is_open()) {
+        return;
+    }
+    write_record(tick, RECORD_END);
+    flush();
+    file.close();
+    Logger::Log("Input recording finished after " + std::to_string(tick) + " ticks.");
+}
+
+void InputRecorder::flush() {
+    if (file.is_open() && !buffer.empty()) {
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        file.flush();
+    }
+    buffer.clear();
+}
+
+///////////////////////////
+// InputReplay
+///////////////////////////
+
+bool InputReplay::load(const std::string& file_path) {
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file.is_open()) {
+        Logger::Err("Failed to open input recording: " + file_path);
+        return false;
+    }
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    const size_t header_size = sizeof(MAGIC) + 4 + 4 + 8;
+    if (data.size() < header_size || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        Logger::Err("Not an input recording: " + file_path);
+        return false;
+    }
+    uint32_t version = static_cast<uint32_t>(get(data, 4, 4));
+    if (version != VERSION) {
+        Logger::Err("Unsupported input recording version " + std::to_string(version) + ": " + file_path);
+        return false;
+    }
+    header.seed = static_cast<uint32_t>(get(data, 8, 4));
+    header.start_time = static_cast<int64_t>(get(data, 12, 8));
+
+    records.clear();
+    cursor = 0;
+    divergent_tick = -1;
+    bool has_end = false;
+    size_t offset = header_size;
+    while (offset + 5 <= data.size()) {
+        Record record;
+        record.tick = static_cast<uint32_t>(get(data, offset, 4));
+        record.type = static_cast<RecordType>(data[offset + 4]);
+        offset += 5;
+        int payload = record.type == RECORD_KEY_DOWN ? 4 : record.type == RECORD_STATE_HASH ? 8 : 0;
+        if (offset + payload > data.size()) {
+            break;
+        }
+        record.value = get(data, offset, payload);
+        offset += payload;
+        if (record.type == RECORD_END) {
+            end_tick = record.tick;
+            has_end = true;
+            break;
+        }
+        records.push_back(record);
+    }
+    if (!has_end) {
+        // cut short, e.g. the recording run crashed, replay what made it to disk
+        end_tick = records.empty() ? 0 : records.back().tick + 1;
+        Logger::Warn("Input recording has no end marker, replaying " + std::to_string(end_tick) + " ticks: " + file_path);
+    }
+    Logger::Log("Replaying " + file_path + ", " + std::to_string(end_tick) + " ticks, seed " + std::to_string(header.seed) + ".");
+    return true;
+}
+
+void InputReplay::keys_at(uint32_t tick, std::vector<SDL_Keycode>& keys) {
+    // hashes of earlier ticks that were never checked are passed over
+    while (cursor < records.size() && (records[cursor].tick < tick || (records[cursor].tick == tick && records[cursor].type == RECORD_KEY_DOWN))) {
+        if (records[cursor].type == RECORD_KEY_DOWN) {
+            keys.push_back(static_cast<SDL_Keycode>(static_cast<int32_t>(records[cursor].value)));
+        }
+        cursor++;
+    }
+}
+
+bool InputReplay::check_state_hash(uint32_t tick, uint64_t hash) {
+    while (cursor < records.size() && records[cursor].tick < tick) {
+        cursor++;
+    }
+    if (cursor >= records.size() || records[cursor].tick != tick || records[cursor].type != RECORD_STATE_HASH) {
+        // nothing recorded for this tick
+        return true;
+    }
+    bool in_sync = records[cursor].value == hash;
+    cursor++;
+    if (!in_sync && divergent_tick < 0) {
+        divergent_tick = tick;
+        Logger::Err("Replay diverged from the recording at tick " + std::to_string(tick) + ".");
+    }
+    return in_sync;
+}
@@ -0,0 +1,91 @@
+#ifndef INPUT_RECORDING_H
+#define INPUT_RECORDING_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+
+// what a run needs to start the same way again, stored at the head of every recording
+struct RecordingHeader {
+    uint32_t seed = 1;
+    // the wall clock the run started at, seconds since the epoch, level scripts read it through os.time/os.date
+    int64_t start_time = 0;
+};
+
+///////////////////////////
+// Input Recording
+///////////////////////////
+// A compact binary log of the key presses that reached the game, each
+// stamped with the simulation tick it was handled before, so a replay can
+// hand the same keys to the same Update(). With the simulation on the fixed
+// step and Clock in simulated time, the same keys give the same run.
+// The recorder also stores a hash of the simulation state after every tick
+// and the replayer compares against it, so a run that drifts is reported at
+// the first tick it differs instead of by eye at the end.
+//
+// Layout, little endian:
+//   header:  "RPLY", u32 version, u32 seed, i64 start_time
+//   records: u32 tick, u8 type, then an i32 key code (KEY_DOWN),
+//            a u64 state hash (STATE_HASH) or nothing (END)
+///////////////////////////
+
+enum RecordType: uint8_t {
+    RECORD_KEY_DOWN = 0,
+    RECORD_STATE_HASH = 1,
+    RECORD_END = 2
+};
+
+class InputRecorder {
+    private:
+        std::ofstream file;
+        std::vector<unsigned char> buffer;
+
+        void write_record(uint32_t tick, RecordType type);
+        void flush();
+
+    public:
+        ~InputRecorder();
+
+        // false if the file can't be written
+        bool open(const std::string& file_path, const RecordingHeader& header);
+        bool is_open() const { return file.is_open(); }
+
+        void record_key(uint32_t tick, SDL_Keycode key);
+        void record_state_hash(uint32_t tick, uint64_t hash);
+        // writes the end marker, the replay stops at this tick
+        void close(uint32_t tick);
+};
+
+class InputReplay {
+    private:
+        struct Record {
+            uint32_t tick;
+            RecordType type;
+            uint64_t value;
+        };
+        std::vector<Record> records;
+        size_t cursor = 0;
+        RecordingHeader header;
+        uint32_t end_tick = 0;
+        // first tick the state hash didn't match, -1 while in sync
+        int64_t divergent_tick = -1;
+
+    public:
+        // false if the file is missing, isn't a recording or is cut short
+        bool load(const std::string& file_path);
+
+        const RecordingHeader& get_header() const { return header; }
+
+        // the keys recorded before the given tick, ticks have to be asked for in order
+        void keys_at(uint32_t tick, std::vector<SDL_Keycode>& keys);
+
+        // compares against the recorded hash of the tick, logs the first mismatch, true if in sync
+        bool check_state_hash(uint32_t tick, uint64_t hash);
+
+        bool is_finished(uint32_t tick) const { return tick >= end_tick; }
+        int64_t get_divergent_tick() const { return divergent_tick; }
+};
+
+#endif
@@ -0,0 +1,95 @@
+#include "thread_pool.h"
+#include "../logger/logger.h"
+#include "../profiler/profiler.h"
+
+ThreadPool::ThreadPool(int num_workers) {
+    if (num_workers < 0) {
+        unsigned int hardware_threads = std::thread::hardware_concurrency();
+        num_workers = hardware_threads > 1 ? static_cast<int>(hardware_threads) - 1 : 0;
+    }
+    for (int i = 0; i < num_workers; i++) {
+        workers.emplace_back(&ThreadPool::worker_loop, this, static_cast<size_t>(i + 1));
+    }
+    Logger::Log("ThreadPool created with " + std::to_string(num_workers) + " worker threads.");
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        is_stopping = true;
+    }
+    work_ready.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    Logger::Log("ThreadPool destroyed.");
+}
+
+size_t ThreadPool::get_thread_count() const {
+    return workers.size() + 1;
+}
+
+void ThreadPool::run_chunks(size_t thread_index) {
+    while (true) {
+        size_t begin = next_index.fetch_add(job_chunk_size);
+        if (begin >= job_count) {
+            return;
+        }
+        size_t end = begin + job_chunk_size < job_count ? begin + job_chunk_size : job_count;
+        PROFILE_SCOPE("ThreadPool::chunk");
+        (*job)(begin, end, thread_index);
+    }
+}
+
+void ThreadPool::worker_loop(size_t thread_index) {
+    Profiler::set_thread_name("worker " + std::to_string(thread_index));
+    unsigned long seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock, [&] { return is_stopping || generation != seen_generation; });
+            if (is_stopping) {
+                return;
+            }
+            seen_generation = generation;
+        }
+
+        run_chunks(thread_index);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        pending_workers--;
+        if (pending_workers == 0) {
+            work_done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallel_for(size_t count, size_t chunk_size, const ParallelForFunction& func) {
+    if (count == 0) {
+        return;
+    }
+    chunk_size = chunk_size > 0 ? chunk_size : 1;
+
+    // not worth waking anybody up for a single chunk
+    if (workers.empty() || count <= chunk_size) {
+        func(0, count, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &func;
+        job_count = count;
+        job_chunk_size = chunk_size;
+        next_index.store(0);
+        pending_workers = workers.size();
+        generation++;
+    }
+    work_ready.notify_all();
+
+    run_chunks(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [&] { return pending_workers == 0; });
+    job = nullptr;
+}
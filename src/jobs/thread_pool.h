@@ -0,0 +1,56 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+///////////////////////////
+// Thread Pool
+///////////////////////////
+// A fixed set of worker threads that sleep until parallel_for() hands them
+// work. The calling thread always takes part as thread index 0, so a pool
+// with no workers simply runs everything inline.
+///////////////////////////
+
+typedef std::function<void(size_t begin, size_t end, size_t thread_index)> ParallelForFunction;
+
+class ThreadPool {
+    private:
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::condition_variable work_ready;
+        std::condition_variable work_done;
+
+        // the job currently being run, only valid while pending_workers > 0
+        const ParallelForFunction* job = nullptr;
+        size_t job_count = 0;
+        size_t job_chunk_size = 1;
+        std::atomic<size_t> next_index{0};
+        size_t pending_workers = 0;
+        unsigned long generation = 0;
+        bool is_stopping = false;
+
+        void worker_loop(size_t thread_index);
+        void run_chunks(size_t thread_index);
+
+    public:
+        // num_workers < 0 picks one worker per spare hardware thread
+        ThreadPool(int num_workers = -1);
+        ~ThreadPool();
+
+        // number of threads that can run a job, including the caller
+        size_t get_thread_count() const;
+
+        // Splits [0, count) into chunks of chunk_size and runs func on them across the pool.
+        // Blocks until every chunk is done. Chunks are handed out dynamically, so which thread
+        // runs which chunk is not deterministic; callers that need a stable result must merge
+        // their per-thread output in a fixed order.
+        void parallel_for(size_t count, size_t chunk_size, const ParallelForFunction& func);
+};
+
+#endif
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <cstdlib>
+#include <string>
 #include "game/game.h"
 #include "logger/logger.h"
 #include <sol/sol.hpp>
@@ -7,6 +9,32 @@
 int main(int argc, char* argv[]) {
 
     Game game;
+    // --headless runs the simulation without a window, --ticks N stops it after N updates
+    // --trace N writes a profiler trace of the frames from frame N on, frame 0 loads the level
+    // --record FILE writes the key presses to FILE, --replay FILE plays them back, --seed N fixes Lua's random numbers
+    bool is_headless = false;
+    int ticks = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            is_headless = true;
+        } else if (arg == "--ticks" && i + 1 < argc) {
+            ticks = std::atoi(argv[++i]);
+        } else if (arg == "--record" && i + 1 < argc) {
+            game.set_recording(argv[++i]);
+        } else if (arg == "--replay" && i + 1 < argc) {
+            game.set_replay(argv[++i]);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            game.set_trace_at_frame(std::atoi(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            game.set_seed(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+        } else {
+            Logger::Err("Unknown argument: " + arg);
+        }
+    }
+    if (is_headless) {
+        game.set_headless(ticks);
+    }
     game.Initialize();
     game.Run();
     game.Destroy();
@@ -0,0 +1,61 @@
+#include "allocation_tracker.h"
+
+#ifdef ENABLE_ALLOCATION_TRACKING
+
+#include <cstdlib>
+#include <new>
+
+// The replacements cover the plain and array forms with their nothrow and sized variants. The
+// over-aligned forms keep the library's versions, they allocate and free on their own paths and
+// are not counted.
+
+void* operator new(std::size_t size) {
+    AllocationTracker::record_allocation(size);
+    void* memory = std::malloc(size > 0 ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    AllocationTracker::record_allocation(size);
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return ::operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept {
+    if (memory) {
+        AllocationTracker::record_free();
+        std::free(memory);
+    }
+}
+
+void operator delete[](void* memory) noexcept {
+    ::operator delete(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    ::operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    ::operator delete(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    ::operator delete(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    ::operator delete(memory);
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+struct AllocationCounts {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    uint64_t frees = 0;
+};
+
+///////////////////////////
+// Allocation Tracker
+///////////////////////////
+// Counts heap allocations. Built with ENABLE_ALLOCATION_TRACKING, the
+// global operator new and delete are replaced by versions that count
+// before they call malloc and free. Every thread keeps its own counters,
+// so a profiler scope can take the difference between its start and end
+// and know what it allocated, nested scopes included. The totals over all
+// threads give the count per frame.
+// Built without it, nothing is replaced and every count reads 0.
+///////////////////////////
+
+class AllocationTracker {
+    private:
+        inline static thread_local uint64_t thread_allocations = 0;
+        inline static thread_local uint64_t thread_bytes = 0;
+        inline static std::atomic<uint64_t> total_allocations{0};
+        inline static std::atomic<uint64_t> total_bytes{0};
+        inline static std::atomic<uint64_t> total_frees{0};
+
+    public:
+        static void record_allocation(size_t size) {
+            thread_allocations++;
+            thread_bytes += size;
+            total_allocations.fetch_add(1, std::memory_order_relaxed);
+            total_bytes.fetch_add(size, std::memory_order_relaxed);
+        }
+
+        static void record_free() {
+            total_frees.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // the calling thread's allocations so far, frees are only counted in total
+        static AllocationCounts thread_counts() {
+            AllocationCounts counts;
+#ifdef ENABLE_ALLOCATION_TRACKING
+            counts.allocations = thread_allocations;
+            counts.bytes = thread_bytes;
+#endif
+            return counts;
+        }
+
+        // every thread's allocations and frees so far
+        static AllocationCounts total_counts() {
+            AllocationCounts counts;
+#ifdef ENABLE_ALLOCATION_TRACKING
+            counts.allocations = total_allocations.load(std::memory_order_relaxed);
+            counts.bytes = total_bytes.load(std::memory_order_relaxed);
+            counts.frees = total_frees.load(std::memory_order_relaxed);
+#endif
+            return counts;
+        }
+
+        static bool is_enabled() {
+#ifdef ENABLE_ALLOCATION_TRACKING
+            return true;
+#else
+            return false;
+#endif
+        }
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef PROFILE_SCOPE_H
+#define PROFILE_SCOPE_H
+
+#include <cstdint>
+
+// PROFILE_SCOPE("name") times the rest of the enclosing block, the name must be a string literal.
+// Built without ENABLE_PROFILER the markers compile to nothing.
+// This header is all a file needs to place markers, it stays free of SDL and the profiler's internals.
+#ifdef ENABLE_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
+
+struct ProfileThreadBuffer;
+
+// records the time between construction and destruction into the calling thread's buffer, see Profiler
+class ProfileScope {
+    private:
+        const char* name;
+        ProfileThreadBuffer& buffer;
+        uint16_t depth;
+        uint64_t start;
+        uint64_t start_allocations;
+        uint64_t start_allocated_bytes;
+
+    public:
+        explicit ProfileScope(const char* name);
+        ~ProfileScope();
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#endif
@@ -0,0 +1,226 @@
+#include "profiler.h"
+#include "../logger/logger.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <SDL2/SDL.h>
+
+std::mutex Profiler::buffers_mutex;
+std::vector<std::unique_ptr<ProfileThreadBuffer>> Profiler::buffers;
+uint64_t Profiler::frame_start = 0;
+double Profiler::ticks_to_ms = 0;
+FrameProfile Profiler::frame_profile;
+int Profiler::frames_recorded = 0;
+uint64_t Profiler::frames_total = 0;
+AllocationCounts Profiler::frame_start_allocations;
+AllocationCounts Profiler::total_frame_allocations;
+std::string Profiler::capture_path;
+int Profiler::capture_frames_left = 0;
+uint64_t Profiler::capture_start = 0;
+std::vector<TraceEvent> Profiler::captured_events;
+std::vector<TraceCounter> Profiler::captured_counters;
+
+ProfileScope::ProfileScope(const char* name): name(name), buffer(Profiler::thread_buffer()) {
+    depth = buffer.depth++;
+    AllocationCounts allocations = AllocationTracker::thread_counts();
+    start_allocations = allocations.allocations;
+    start_allocated_bytes = allocations.bytes;
+    start = Profiler::now();
+}
+
+ProfileScope::~ProfileScope() {
+    uint64_t end = Profiler::now();
+    AllocationCounts allocations = AllocationTracker::thread_counts();
+    buffer.depth--;
+    buffer.push({
+        name,
+        start,
+        end,
+        static_cast<uint32_t>(allocations.allocations - start_allocations),
+        static_cast<uint32_t>(allocations.bytes - start_allocated_bytes),
+        depth
+    });
+}
+
+uint64_t Profiler::now() {
+    return SDL_GetPerformanceCounter();
+}
+
+ProfileThreadBuffer* Profiler::register_thread() {
+    // once per thread, the buffers live until the program exits so a late reader never sees a dangling one
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    buffers.push_back(std::make_unique<ProfileThreadBuffer>());
+    buffers.back()->thread_index = static_cast<uint16_t>(buffers.size() - 1);
+    return buffers.back().get();
+}
+
+ProfileScopeStats& Profiler::find_scope(const char* name) {
+    // the same literal can have a different address in every translation unit
+    for (auto& scope : frame_profile.scopes) {
+        if (scope.name == name || std::strcmp(scope.name, name) == 0) {
+            return scope;
+        }
+    }
+    ProfileScopeStats scope;
+    scope.name = name;
+    scope.history.assign(HISTORY_SIZE, 0.0f);
+    frame_profile.scopes.push_back(scope);
+    return frame_profile.scopes.back();
+}
+
+void Profiler::set_thread_name(const std::string& name) {
+    ProfileThreadBuffer& buffer = thread_buffer();
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    buffer.name = name;
+}
+
+void Profiler::begin_frame() {
+    frame_start = now();
+    frame_start_allocations = AllocationTracker::total_counts();
+}
+
+void Profiler::start_capture(const std::string& file_path, int frames) {
+    if (is_capturing() || frames <= 0) {
+        return;
+    }
+    capture_path = file_path;
+    capture_frames_left = frames;
+    // the frame that asked for it is captured whole
+    capture_start = frame_start;
+    captured_events.clear();
+    captured_counters.clear();
+    Logger::Log("Capturing a trace of " + std::to_string(frames) + " frames.");
+}
+
+void Profiler::finish_capture() {
+    if (!is_capturing()) {
+        return;
+    }
+    capture_frames_left = 0;
+    write_capture();
+}
+
+void Profiler::write_capture() {
+    if (ticks_to_ms == 0) {
+        ticks_to_ms = 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+    std::vector<std::string> thread_names;
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        for (auto& buffer : buffers) {
+            thread_names.push_back(buffer->name);
+        }
+    }
+    TraceWriter::write_chrome_trace(capture_path, captured_events, captured_counters, thread_names, capture_start, 1.0 / (ticks_to_ms * 1000.0));
+    captured_events.clear();
+    captured_events.shrink_to_fit();
+    captured_counters.clear();
+    captured_counters.shrink_to_fit();
+}
+
+void Profiler::end_frame() {
+    uint64_t frame_end = now();
+    if (ticks_to_ms == 0) {
+        ticks_to_ms = 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+    frame_profile.frame_ms = static_cast<float>((frame_end - frame_start) * ticks_to_ms);
+    AllocationCounts frame_end_allocations = AllocationTracker::total_counts();
+    frame_profile.allocations = frame_end_allocations.allocations - frame_start_allocations.allocations;
+    frame_profile.allocated_bytes = frame_end_allocations.bytes - frame_start_allocations.bytes;
+    frame_profile.frees = frame_end_allocations.frees - frame_start_allocations.frees;
+    total_frame_allocations.allocations += frame_profile.allocations;
+    total_frame_allocations.bytes += frame_profile.allocated_bytes;
+    total_frame_allocations.frees += frame_profile.frees;
+    frames_total++;
+    frame_profile.markers.clear();
+    for (auto& scope : frame_profile.scopes) {
+        scope.last_ms = 0;
+        scope.calls = 0;
+        scope.last_allocations = 0;
+        scope.last_allocated_bytes = 0;
+    }
+
+    std::unique_lock<std::mutex> lock(buffers_mutex);
+    for (auto& buffer : buffers) {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        // a thread that wrapped around since the last frame only has its newest CAPACITY markers left
+        uint64_t first = std::max(buffer->read_cursor, head > ProfileThreadBuffer::CAPACITY ? head - ProfileThreadBuffer::CAPACITY : 0);
+        for (uint64_t i = first; i < head; i++) {
+            const ProfileMarker& marker = buffer->markers[i % ProfileThreadBuffer::CAPACITY];
+            // scopes that ended before the frame, e.g. while loading the level
+            if (marker.end < frame_start) {
+                continue;
+            }
+            uint64_t start = std::max(marker.start, frame_start);
+            float duration_ms = static_cast<float>((marker.end - marker.start) * ticks_to_ms);
+            frame_profile.markers.push_back({
+                marker.name,
+                static_cast<float>((start - frame_start) * ticks_to_ms),
+                static_cast<float>((marker.end - frame_start) * ticks_to_ms),
+                marker.depth,
+                buffer->thread_index
+            });
+            ProfileScopeStats& scope = find_scope(marker.name);
+            scope.last_ms += duration_ms;
+            scope.calls++;
+            scope.last_allocations += marker.allocations;
+            scope.last_allocated_bytes += marker.allocated_bytes;
+            scope.total_allocations += marker.allocations;
+            scope.total_allocated_bytes += marker.allocated_bytes;
+            if (is_capturing()) {
+                captured_events.push_back({marker.name, marker.start, marker.end, marker.allocations, marker.allocated_bytes, buffer->thread_index});
+            }
+        }
+        buffer->read_cursor = head;
+    }
+    frame_profile.thread_count = static_cast<int>(buffers.size());
+    lock.unlock();
+
+    int slot = frame_profile.history_offset;
+    frames_recorded = std::min(frames_recorded + 1, static_cast<int>(HISTORY_SIZE));
+    for (auto& scope : frame_profile.scopes) {
+        scope.history[slot] = scope.last_ms;
+        float sum = 0;
+        float max = 0;
+        for (float ms : scope.history) {
+            sum += ms;
+            max = std::max(max, ms);
+        }
+        scope.average_ms = sum / frames_recorded;
+        scope.max_ms = max;
+    }
+    frame_profile.history_offset = (slot + 1) % HISTORY_SIZE;
+
+    if (is_capturing() && --capture_frames_left == 0) {
+        write_capture();
+    }
+}
+
+bool Profiler::write_allocation_report(const std::string& file_path) {
+    std::ofstream file(file_path, std::ios::trunc);
+    if (!file.is_open()) {
+        Logger::Err("Failed to open allocation report for writing: " + file_path);
+        return false;
+    }
+    double frames = frames_total > 0 ? static_cast<double>(frames_total) : 1.0;
+    file << "Heap allocations over " << frames_total << " frames\n";
+    file << "per frame: " << total_frame_allocations.allocations / frames << " allocations, "
+         << total_frame_allocations.bytes / frames << " bytes, " << total_frame_allocations.frees / frames << " frees\n";
+    file << "last frame: " << frame_profile.allocations << " allocations, " << frame_profile.allocated_bytes << " bytes, " << frame_profile.frees << " frees\n\n";
+    // a scope's count includes the scopes nested in it
+    file << "scope, allocations per frame, bytes per frame, allocations last frame, bytes last frame\n";
+
+    std::vector<const ProfileScopeStats*> scopes;
+    for (const auto& scope : frame_profile.scopes) {
+        scopes.push_back(&scope);
+    }
+    std::sort(scopes.begin(), scopes.end(), [](const ProfileScopeStats* a, const ProfileScopeStats* b) {
+        return a->total_allocations > b->total_allocations;
+    });
+    for (const ProfileScopeStats* scope : scopes) {
+        file << scope->name << ", " << scope->total_allocations / frames << ", " << scope->total_allocated_bytes / frames << ", "
+             << scope->last_allocations << ", " << scope->last_allocated_bytes << "\n";
+    }
+    Logger::Log("Wrote the allocation report to " + file_path + ".");
+    return file.good();
+}
@@ -0,0 +1,176 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "profile_scope.h"
+#include "trace_writer.h"
+#include "allocation_tracker.h"
+
+// PROFILE_COUNTER("name", value) adds a sample to a counter track of the running capture
+#ifdef ENABLE_PROFILER
+#define PROFILE_COUNTER(name, value) Profiler::record_counter(name, value)
+#else
+#define PROFILE_COUNTER(name, value)
+#endif
+
+// one finished scope, times in performance counter ticks
+struct ProfileMarker {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+    // heap allocations made inside the scope, nested scopes included, 0 without allocation tracking
+    uint32_t allocations;
+    uint32_t allocated_bytes;
+    uint16_t depth;
+};
+
+// a marker of the last frame, relative to the frame start, for the timeline
+struct TimelineMarker {
+    const char* name;
+    float start_ms;
+    float end_ms;
+    uint16_t depth;
+    uint16_t thread;
+};
+
+// a scope's time per frame, every call in the frame added up
+struct ProfileScopeStats {
+    const char* name;
+    float last_ms = 0;
+    float average_ms = 0;
+    float max_ms = 0;
+    int calls = 0;
+    uint32_t last_allocations = 0;
+    uint64_t last_allocated_bytes = 0;
+    // since the first frame, for the allocation report
+    uint64_t total_allocations = 0;
+    uint64_t total_allocated_bytes = 0;
+    // last Profiler::HISTORY_SIZE frames, oldest at history_offset
+    std::vector<float> history;
+};
+
+struct FrameProfile {
+    float frame_ms = 0;
+    int thread_count = 0;
+    // every thread's heap traffic over the frame, 0 without allocation tracking
+    uint64_t allocations = 0;
+    uint64_t allocated_bytes = 0;
+    uint64_t frees = 0;
+    int history_offset = 0;
+    std::vector<TimelineMarker> markers;
+    std::vector<ProfileScopeStats> scopes;
+};
+
+// Markers of one thread. Only the owning thread writes, the main thread reads them at the end of a frame.
+// The write index is published with release, so the reader never sees a marker before it is complete.
+struct ProfileThreadBuffer {
+    static const size_t CAPACITY = 4096;
+    ProfileMarker markers[CAPACITY];
+    std::atomic<uint64_t> head{0};
+    // reader side, only touched by the main thread
+    uint64_t read_cursor = 0;
+    // writer side, only touched by the owning thread
+    uint16_t depth = 0;
+    uint16_t thread_index = 0;
+    // shown in exported traces, guarded by the profiler's buffer mutex
+    std::string name;
+
+    void push(const ProfileMarker& marker) {
+        uint64_t index = head.load(std::memory_order_relaxed);
+        markers[index % CAPACITY] = marker;
+        head.store(index + 1, std::memory_order_release);
+    }
+};
+
+///////////////////////////
+// Profiler
+///////////////////////////
+// Scoped timing markers for the main loop and the worker threads. Every
+// thread writes finished scopes into a ring buffer of its own without any
+// locking. At end_frame() the main thread drains the buffers into a
+// timeline of the frame and a rolling per-scope history, which the debug
+// GUI draws. A thread that records more than CAPACITY markers in one frame
+// loses its oldest ones.
+// A capture also keeps every marker and counter sample of a number of
+// frames and writes them out as a Chrome trace when it ends.
+///////////////////////////
+
+class Profiler {
+    private:
+        inline static thread_local ProfileThreadBuffer* current_buffer = nullptr;
+        static std::mutex buffers_mutex;
+        static std::vector<std::unique_ptr<ProfileThreadBuffer>> buffers;
+        static uint64_t frame_start;
+        static double ticks_to_ms;
+        static FrameProfile frame_profile;
+        static int frames_recorded;
+        static uint64_t frames_total;
+        static AllocationCounts frame_start_allocations;
+        static AllocationCounts total_frame_allocations;
+
+        // trace capture, every marker and counter of the captured frames is kept for the export
+        static std::string capture_path;
+        static int capture_frames_left;
+        static uint64_t capture_start;
+        static std::vector<TraceEvent> captured_events;
+        static std::vector<TraceCounter> captured_counters;
+
+        static ProfileThreadBuffer* register_thread();
+        static ProfileScopeStats& find_scope(const char* name);
+        static void write_capture();
+
+    public:
+        static const int HISTORY_SIZE = 120;
+
+        // performance counter ticks, out of line so only profiler.cpp needs SDL
+        static uint64_t now();
+
+        static ProfileThreadBuffer& thread_buffer() {
+            if (!current_buffer) {
+                current_buffer = register_thread();
+            }
+            return *current_buffer;
+        }
+
+        static void begin_frame();
+        // collects every marker finished since begin_frame(), call when no job is running
+        static void end_frame();
+
+        // the last completed frame
+        static const FrameProfile& get_frame_profile() { return frame_profile; }
+
+        // how the calling thread is labelled in exported traces
+        static void set_thread_name(const std::string& name);
+
+        // keeps every marker from the current frame on for the given number of frames, then writes them
+        // to file_path as a Chrome trace, ignored while a capture is running
+        static void start_capture(const std::string& file_path, int frames);
+        // writes a capture that is still running, e.g. when the game quits before it is done
+        static void finish_capture();
+        static bool is_capturing() { return capture_frames_left > 0; }
+
+        // every scope's allocations per frame since the start, most allocating first, false if the file can't be written
+        static bool write_allocation_report(const std::string& file_path);
+
+        // a sample for a counter track, main thread only, dropped unless a capture is running
+        static void record_counter(const char* name, int64_t value) {
+            if (is_capturing()) {
+                captured_counters.push_back({name, now(), value});
+            }
+        }
+
+        static bool is_enabled() {
+#ifdef ENABLE_PROFILER
+            return true;
+#else
+            return false;
+#endif
+        }
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "trace_writer.h"
+#include "../logger/logger.h"
+#include <cstdio>
+#include <fstream>
+
+namespace {
+    // scope and thread names are plain identifiers, but a quote or backslash must not break the file
+    void write_string(std::ofstream& file, const std::string& text) {
+        file << '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                file << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                file << ' ';
+            } else {
+                file << c;
+            }
+        }
+        file << '"';
+    }
+
+    void write_time(std::ofstream& file, double microseconds) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.3f", microseconds);
+        file << buffer;
+    }
+}
+
+bool TraceWriter::write_chrome_trace(const std::string& file_path, const std::vector<TraceEvent>& events, const std::vector<TraceCounter>& counters,
+    const std::vector<std::string>& thread_names, uint64_t origin, double ticks_per_microsecond) {
+    std::ofstream file(file_path, std::ios::trunc);
+    if (!file.is_open()) {
+        Logger::Err("Failed to open trace file for writing: " + file_path);
+        return false;
+    }
+    auto to_microseconds = [&](uint64_t ticks) {
+        return ticks >= origin ? (ticks - origin) / ticks_per_microsecond : 0.0;
+    };
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) {
+            file << ",\n";
+        }
+        first = false;
+    };
+
+    separator();
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"game_engine\"}}";
+    for (size_t i = 0; i < thread_names.size(); i++) {
+        separator();
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":";
+        write_string(file, thread_names[i].empty() ? "thread " + std::to_string(i) : thread_names[i]);
+        file << "}}";
+    }
+
+    for (const auto& event : events) {
+        separator();
+        file << "{\"name\":";
+        write_string(file, event.name);
+        file << ",\"cat\":\"engine\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":";
+        write_time(file, to_microseconds(event.start));
+        file << ",\"dur\":";
+        write_time(file, (event.end - event.start) / ticks_per_microsecond);
+        if (event.allocations > 0) {
+            file << ",\"args\":{\"allocations\":" << event.allocations << ",\"bytes\":" << event.allocated_bytes << "}";
+        }
+        file << "}";
+    }
+
+    for (const auto& counter : counters) {
+        separator();
+        file << "{\"name\":";
+        write_string(file, counter.name);
+        file << ",\"ph\":\"C\",\"pid\":1,\"ts\":";
+        write_time(file, to_microseconds(counter.time));
+        file << ",\"args\":{\"value\":" << counter.value << "}}";
+    }
+
+    file << "\n]}\n";
+    if (!file.good()) {
+        Logger::Err("Failed to write trace file: " + file_path);
+        return false;
+    }
+    Logger::Log("Wrote " + std::to_string(events.size()) + " trace events and " + std::to_string(counters.size()) + " counter samples to " + file_path + ".");
+    return true;
+}
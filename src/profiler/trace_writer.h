@@ -0,0 +1,43 @@
+#ifndef TRACE_WRITER_H
+#define TRACE_WRITER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// a finished scope, times in performance counter ticks
+struct TraceEvent {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+    uint32_t allocations;
+    uint32_t allocated_bytes;
+    uint16_t thread;
+};
+
+// one sample of a counter track
+struct TraceCounter {
+    const char* name;
+    uint64_t time;
+    int64_t value;
+};
+
+///////////////////////////
+// Trace Writer
+///////////////////////////
+// Writes captured profiler scopes as a Chrome trace_event JSON file. The
+// file opens in chrome://tracing and in the Perfetto UI. Scopes become
+// complete ("X") events on their thread's track, counters become counter
+// ("C") tracks, and each thread gets its name through a metadata event.
+// Scopes that allocated carry their allocation count and bytes as args.
+// Times are written in microseconds from the start of the capture.
+///////////////////////////
+
+class TraceWriter {
+    public:
+        // thread_names is indexed by TraceEvent::thread, false if the file can't be written
+        static bool write_chrome_trace(const std::string& file_path, const std::vector<TraceEvent>& events, const std::vector<TraceCounter>& counters,
+            const std::vector<std::string>& thread_names, uint64_t origin, double ticks_per_microsecond);
+};
+
+#endif
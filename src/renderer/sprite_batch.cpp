@@ -0,0 +1,192 @@
+#include "sprite_batch.h"
+#include "../asset_store/asset_store.h"
+#include <algorithm>
+#include <cmath>
+
+void SpriteBatch::begin(const AssetStore& asset_store) {
+    this->asset_store = &asset_store;
+    quads.clear();
+    keys.clear();
+}
+
+void SpriteBatch::draw(int texture_handle, const SDL_Rect& src_rect, const SDL_FRect& dst_rect, double angle, SDL_RendererFlip flip, SDL_Color color, int layer) {
+    const TextureRegion* region = asset_store->get_texture_region(texture_handle);
+    if (region == nullptr) {
+        return;
+    }
+    Quad quad;
+    quad.page = region->page;
+    quad.src_rect = {region->rect.x + src_rect.x, region->rect.y + src_rect.y, src_rect.w, src_rect.h};
+    quad.flip = flip;
+    quad.color = color;
+
+    float half_w = dst_rect.w * 0.5f;
+    float half_h = dst_rect.h * 0.5f;
+    float center_x = dst_rect.x + half_w;
+    float center_y = dst_rect.y + half_h;
+    const float offsets[4][2] = {{-half_w, -half_h}, {half_w, -half_h}, {half_w, half_h}, {-half_w, half_h}};
+
+    if (angle == 0.0) {
+        for (int i = 0; i < 4; i++) {
+            quad.corners[i] = {center_x + offsets[i][0], center_y + offsets[i][1]};
+        }
+    } else {
+        // y points down on screen, so this turns clockwise just like SDL_RenderCopyEx
+        float radians = static_cast<float>(angle * M_PI / 180.0);
+        float c = std::cos(radians);
+        float s = std::sin(radians);
+        for (int i = 0; i < 4; i++) {
+            float x = offsets[i][0];
+            float y = offsets[i][1];
+            quad.corners[i] = {center_x + x * c - y * s, center_y + x * s + y * c};
+        }
+    }
+    float min_x = quad.corners[0].x;
+    float max_x = quad.corners[0].x;
+    float min_y = quad.corners[0].y;
+    float max_y = quad.corners[0].y;
+    for (int i = 1; i < 4; i++) {
+        min_x = std::min(min_x, quad.corners[i].x);
+        max_x = std::max(max_x, quad.corners[i].x);
+        min_y = std::min(min_y, quad.corners[i].y);
+        max_y = std::max(max_y, quad.corners[i].y);
+    }
+    quad.bounds = {min_x, min_y, max_x - min_x, max_y - min_y};
+
+    keys.push_back((static_cast<uint64_t>(layer & 0xFF) << KEY_LAYER_SHIFT) | static_cast<uint64_t>(quads.size()));
+    quads.push_back(quad);
+}
+
+void SpriteBatch::sort_keys() {
+    // one stable counting pass on the layer byte. The keys come in with
+    // increasing submission index, so inside a layer they stay in the order
+    // they were drawn, which is the order overlapping sprites must keep.
+    size_t counts[256] = {};
+    for (uint64_t key : keys) {
+        counts[key >> KEY_LAYER_SHIFT]++;
+    }
+    // most frames only use a layer or two, nothing to do when there is one
+    if (counts[keys[0] >> KEY_LAYER_SHIFT] == keys.size()) {
+        return;
+    }
+    size_t offset = 0;
+    for (size_t& count : counts) {
+        size_t bucket_size = count;
+        count = offset;
+        offset += bucket_size;
+    }
+    sort_scratch.resize(keys.size());
+    for (uint64_t key : keys) {
+        sort_scratch[counts[key >> KEY_LAYER_SHIFT]++] = key;
+    }
+    keys.swap(sort_scratch);
+}
+
+static bool bounds_overlap(const SDL_FRect& a, const SDL_FRect& b) {
+    // sprites that only touch along an edge, like tiles, don't cover each other
+    return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+void SpriteBatch::build_batches() {
+    // Moving a quad back into an earlier batch draws it before every batch
+    // after that one. That is only invisible if none of them overlap it, so
+    // the search stops at the first one that does, and the quad starts a
+    // batch of its own.
+    batches.clear();
+    next_in_batch.assign(quads.size(), NO_QUAD);
+    for (uint64_t key : keys) {
+        uint32_t index = static_cast<uint32_t>(key);
+        const Quad& quad = quads[index];
+
+        Batch* target = nullptr;
+        size_t lookback_end = batches.size() > MAX_BATCH_LOOKBACK ? batches.size() - MAX_BATCH_LOOKBACK : 0;
+        for (size_t b = batches.size(); b > lookback_end; b--) {
+            Batch& batch = batches[b - 1];
+            if (batch.page == quad.page) {
+                target = &batch;
+                break;
+            }
+            if (bounds_overlap(batch.bounds, quad.bounds)) {
+                break;
+            }
+        }
+
+        if (target == nullptr) {
+            batches.push_back({quad.page, quad.bounds, index, index});
+            continue;
+        }
+        next_in_batch[target->last] = index;
+        target->last = index;
+        float min_x = std::min(target->bounds.x, quad.bounds.x);
+        float min_y = std::min(target->bounds.y, quad.bounds.y);
+        float max_x = std::max(target->bounds.x + target->bounds.w, quad.bounds.x + quad.bounds.w);
+        float max_y = std::max(target->bounds.y + target->bounds.h, quad.bounds.y + quad.bounds.h);
+        target->bounds = {min_x, min_y, max_x - min_x, max_y - min_y};
+    }
+}
+
+void SpriteBatch::flush(SDL_Renderer* renderer) {
+    stats = RenderStats();
+    stats.sprites = static_cast<int>(quads.size());
+    stats.atlas_pages = asset_store->get_atlas_page_count();
+    stats.atlas_occupancy = asset_store->get_atlas_occupancy();
+
+    if (keys.empty()) {
+        return;
+    }
+    sort_keys();
+    build_batches();
+    stats.batches = static_cast<int>(batches.size());
+
+    for (const Batch& batch : batches) {
+        SDL_Texture* texture = asset_store->get_atlas_page(batch.page);
+        if (texture == nullptr) {
+            continue;
+        }
+
+        // texture coordinates are normalized, so the page size is needed once per batch
+        int texture_width = 0;
+        int texture_height = 0;
+        SDL_QueryTexture(texture, NULL, NULL, &texture_width, &texture_height);
+        float inverse_width = texture_width > 0 ? 1.0f / texture_width : 0.0f;
+        float inverse_height = texture_height > 0 ? 1.0f / texture_height : 0.0f;
+
+        vertices.clear();
+        indices.clear();
+        for (uint32_t i = batch.first; i != NO_QUAD; i = next_in_batch[i]) {
+            const Quad& quad = quads[i];
+            float u0 = quad.src_rect.x * inverse_width;
+            float v0 = quad.src_rect.y * inverse_height;
+            float u1 = (quad.src_rect.x + quad.src_rect.w) * inverse_width;
+            float v1 = (quad.src_rect.y + quad.src_rect.h) * inverse_height;
+            if (quad.flip & SDL_FLIP_HORIZONTAL) {
+                std::swap(u0, u1);
+            }
+            if (quad.flip & SDL_FLIP_VERTICAL) {
+                std::swap(v0, v1);
+            }
+
+            int base = static_cast<int>(vertices.size());
+            vertices.push_back({quad.corners[0], quad.color, {u0, v0}});
+            vertices.push_back({quad.corners[1], quad.color, {u1, v0}});
+            vertices.push_back({quad.corners[2], quad.color, {u1, v1}});
+            vertices.push_back({quad.corners[3], quad.color, {u0, v1}});
+            indices.insert(indices.end(), {base, base + 1, base + 2, base + 2, base + 3, base});
+
+            if (vertices.size() >= MAX_QUADS_PER_CALL * 4) {
+                submit(renderer, texture);
+            }
+        }
+        submit(renderer, texture);
+    }
+}
+
+void SpriteBatch::submit(SDL_Renderer* renderer, SDL_Texture* texture) {
+    if (indices.empty()) {
+        return;
+    }
+    SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size()));
+    stats.draw_calls++;
+    vertices.clear();
+    indices.clear();
+}
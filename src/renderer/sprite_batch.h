@@ -0,0 +1,97 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <cstdint>
+#include <vector>
+#include <SDL2/SDL.h>
+
+class AssetStore;
+
+// what the last flush cost, shown in the debug panel
+struct RenderStats {
+    int sprites = 0;
+    // groups of sprites sharing an atlas page that are drawn together
+    int batches = 0;
+    int draw_calls = 0;
+    int atlas_pages = 0;
+    float atlas_occupancy = 0;
+};
+
+///////////////////////////
+// Sprite Batch
+///////////////////////////
+// Collects plain data quads for a frame, each holding an atlas page index
+// and a source rectangle already moved onto that page. Layers are drawn in
+// order, a counting sort on the layer keeps submission order inside each.
+// Within a layer a quad joins the latest batch of its atlas page if none of
+// the batches after that one overlap it, otherwise it starts a new batch.
+// Anything that overlaps is therefore still drawn in submission order, and
+// only sprites that can't cover each other are reordered to share a batch.
+// Every batch is one SDL_RenderGeometry call instead of one
+// SDL_RenderCopyEx per sprite. The buffers keep their capacity from frame
+// to frame.
+// Rotation and flip are baked into the vertices, and tint and alpha go into
+// the vertex colors. No texture color/alpha mods change between sprites.
+// Blending comes from the page's own blend mode, so the page also decides
+// the blend state of its batch.
+// Requires SDL 2.0.18, works with every renderer including the software one.
+///////////////////////////
+
+class SpriteBatch {
+    private:
+        struct Quad {
+            int page;
+            // in page pixels
+            SDL_Rect src_rect;
+            // corners in screen space: top left, top right, bottom right, bottom left
+            SDL_FPoint corners[4];
+            // screen space bounds of the corners, for the overlap test
+            SDL_FRect bounds;
+            SDL_RendererFlip flip;
+            SDL_Color color;
+        };
+        // quads of one page drawn together, linked through next_in_batch
+        struct Batch {
+            int page;
+            SDL_FRect bounds;
+            uint32_t first;
+            uint32_t last;
+        };
+        std::vector<Quad> quads;
+        // layer:8 | unused:24 | submission index:32, the low half is also the index into quads
+        std::vector<uint64_t> keys;
+        std::vector<uint64_t> sort_scratch;
+        std::vector<Batch> batches;
+        std::vector<uint32_t> next_in_batch;
+        std::vector<SDL_Vertex> vertices;
+        std::vector<int> indices;
+        RenderStats stats;
+        const AssetStore* asset_store = nullptr;
+
+        static const int KEY_LAYER_SHIFT = 56;
+        // how many batches back a quad looks for one of its page, past that it starts a new batch
+        static const size_t MAX_BATCH_LOOKBACK = 16;
+        static constexpr uint32_t NO_QUAD = 0xFFFFFFFFu;
+
+        static const size_t MAX_QUADS_PER_CALL = 16384;
+
+        void sort_keys();
+        void build_batches();
+        void submit(SDL_Renderer* renderer, SDL_Texture* texture);
+
+    public:
+        SpriteBatch() = default;
+
+        // texture handles passed to draw() are looked up in asset_store until the next begin()
+        void begin(const AssetStore& asset_store);
+        // dst_rect is in screen space, angle is in degrees clockwise around the center of dst_rect, like SDL_RenderCopyEx
+        // layer must be below 256, higher layers are drawn on top
+        // src_rect is relative to the texture, it is moved onto the texture's atlas page here
+        void draw(int texture_handle, const SDL_Rect& src_rect, const SDL_FRect& dst_rect, double angle, SDL_RendererFlip flip, SDL_Color color, int layer);
+        // draws everything by layer, overlapping quads of a layer in submission order
+        void flush(SDL_Renderer* renderer);
+
+        const RenderStats& get_stats() const { return stats; }
+};
+
+#endif
@@ -0,0 +1,99 @@
+#include "text_cache.h"
+#include "../logger/logger.h"
+
+TextCache::TextCache(size_t budget_bytes) {
+    stats.budget = budget_bytes;
+}
+
+TextCache::~TextCache() {
+    clear();
+}
+
+void TextCache::set_budget(size_t budget_bytes) {
+    stats.budget = budget_bytes;
+    evict_to_budget();
+}
+
+void TextCache::make_key(const std::string& font_id, const std::string& text, SDL_Color color) {
+    // font id and text are split by a byte neither can hold, the color goes last as raw bytes
+    scratch_key.clear();
+    scratch_key.append(font_id);
+    scratch_key.push_back('\0');
+    scratch_key.append(text);
+    scratch_key.push_back('\0');
+    scratch_key.push_back(static_cast<char>(color.r));
+    scratch_key.push_back(static_cast<char>(color.g));
+    scratch_key.push_back(static_cast<char>(color.b));
+    scratch_key.push_back(static_cast<char>(color.a));
+}
+
+bool TextCache::find(const std::string& font_id, const std::string& text, SDL_Color color, int& width, int& height) {
+    make_key(font_id, text, color);
+    auto it = lookup.find(scratch_key);
+    if (it == lookup.end()) {
+        return false;
+    }
+    width = it->second->width;
+    height = it->second->height;
+    return true;
+}
+
+SDL_Texture* TextCache::get(SDL_Renderer* renderer, TTF_Font* font, const std::string& font_id, const std::string& text, SDL_Color color, int& width, int& height) {
+    make_key(font_id, text, color);
+    auto it = lookup.find(scratch_key);
+    if (it != lookup.end()) {
+        stats.hits++;
+        // move to the front without touching the map, list iterators stay valid
+        entries.splice(entries.begin(), entries, it->second);
+        width = it->second->width;
+        height = it->second->height;
+        return it->second->texture;
+    }
+
+    stats.misses++;
+    if (font == nullptr) {
+        return nullptr;
+    }
+    SDL_Surface* surface = TTF_RenderText_Blended(font, text.c_str(), color);
+    if (surface == nullptr) {
+        Logger::Err("Failed to render text \"" + text + "\": " + std::string(TTF_GetError()));
+        return nullptr;
+    }
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    width = surface->w;
+    height = surface->h;
+    SDL_FreeSurface(surface);
+    if (texture == nullptr) {
+        Logger::Err("Failed to create text texture: " + std::string(SDL_GetError()));
+        return nullptr;
+    }
+
+    entries.push_front({scratch_key, texture, width, height});
+    lookup.emplace(scratch_key, entries.begin());
+    stats.bytes += static_cast<size_t>(width) * height * 4;
+    stats.entries = static_cast<int>(entries.size());
+    evict_to_budget();
+    return texture;
+}
+
+void TextCache::evict_to_budget() {
+    while (stats.bytes > stats.budget && entries.size() > 1) {
+        Entry& oldest = entries.back();
+        stats.bytes -= static_cast<size_t>(oldest.width) * oldest.height * 4;
+        stats.evictions++;
+        SDL_DestroyTexture(oldest.texture);
+        lookup.erase(oldest.key);
+        entries.pop_back();
+    }
+    stats.entries = static_cast<int>(entries.size());
+}
+
+void TextCache::clear() {
+    for (auto& entry : entries) {
+        SDL_DestroyTexture(entry.texture);
+    }
+    entries.clear();
+    lookup.clear();
+    stats.bytes = 0;
+    stats.entries = 0;
+}
@@ -0,0 +1,69 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+// counters since the cache was created, shown in the debug panel
+struct TextCacheStats {
+    int hits = 0;
+    int misses = 0;
+    int evictions = 0;
+    int entries = 0;
+    size_t bytes = 0;
+    size_t budget = 0;
+};
+
+///////////////////////////
+// Text Cache
+///////////////////////////
+// Keeps the textures of rendered strings, keyed on font id, text and color,
+// so a label that did not change costs one blit instead of a rasterise, an
+// upload and a destroy every frame.
+// Entries are kept in least recently used order and the oldest ones are
+// destroyed once the textures go over the memory budget (counted as 4 bytes
+// per pixel). The entry used last is never evicted, so a single label
+// bigger than the budget still gets drawn.
+///////////////////////////
+
+class TextCache {
+    private:
+        struct Entry {
+            std::string key;
+            SDL_Texture* texture;
+            int width;
+            int height;
+        };
+        // most recently used at the front
+        std::list<Entry> entries;
+        std::unordered_map<std::string, std::list<Entry>::iterator> lookup;
+        // reused between lookups so a hit does not allocate
+        std::string scratch_key;
+        TextCacheStats stats;
+
+        void make_key(const std::string& font_id, const std::string& text, SDL_Color color);
+        void evict_to_budget();
+
+    public:
+        TextCache(size_t budget_bytes = 4 * 1024 * 1024);
+        ~TextCache();
+
+        void set_budget(size_t budget_bytes);
+
+        // size of the cached texture, false on a miss, does not rasterise anything
+        bool find(const std::string& font_id, const std::string& text, SDL_Color color, int& width, int& height);
+
+        // the texture for the string, rasterised and uploaded on a miss, nullptr if rendering failed
+        SDL_Texture* get(SDL_Renderer* renderer, TTF_Font* font, const std::string& font_id, const std::string& text, SDL_Color color, int& width, int& height);
+
+        // destroys every texture, needed when the renderer loses its device
+        void clear();
+
+        const TextCacheStats& get_stats() const { return stats; }
+};
+
+#endif
@@ -0,0 +1,259 @@
+#include "spatial_index.h"
+#include <algorithm>
+#include <cmath>
+
+// keeps the grid small when a stray entity ends up far outside the map
+const int MAX_INDEX_CELLS = 1 << 16;
+
+SpatialIndex::SpatialIndex(float cell_size) {
+    this->cell_size = cell_size;
+    cell_start.assign(1, 0);
+}
+
+int SpatialIndex::column_of(float x) const {
+    int column = static_cast<int>(std::floor((x - origin_x) * inverse_cell_size));
+    return column < 0 ? 0 : (column >= columns ? columns - 1 : column);
+}
+
+int SpatialIndex::row_of(float y) const {
+    int row = static_cast<int>(std::floor((y - origin_y) * inverse_cell_size));
+    return row < 0 ? 0 : (row >= rows ? rows - 1 : row);
+}
+
+bool SpatialIndex::passes_filter(uint32_t entry, const std::string& group) const {
+    return group.empty() || entities[entry].BelongsToGroup(group);
+}
+
+void SpatialIndex::clear() {
+    entities.clear();
+    positions_x.clear();
+    positions_y.clear();
+}
+
+void SpatialIndex::insert(Entity entity, float x, float y) {
+    entities.push_back(entity);
+    positions_x.push_back(x);
+    positions_y.push_back(y);
+}
+
+void SpatialIndex::build() {
+    size_t count = entities.size();
+    if (count == 0) {
+        columns = rows = 0;
+        cell_start.assign(1, 0);
+        return;
+    }
+
+    float min_x = *std::min_element(positions_x.begin(), positions_x.end());
+    float max_x = *std::max_element(positions_x.begin(), positions_x.end());
+    float min_y = *std::min_element(positions_y.begin(), positions_y.end());
+    float max_y = *std::max_element(positions_y.begin(), positions_y.end());
+
+    float size = cell_size;
+    columns = static_cast<int>((max_x - min_x) / size) + 1;
+    rows = static_cast<int>((max_y - min_y) / size) + 1;
+    while (static_cast<long>(columns) * rows > MAX_INDEX_CELLS) {
+        size *= 2;
+        columns = static_cast<int>((max_x - min_x) / size) + 1;
+        rows = static_cast<int>((max_y - min_y) / size) + 1;
+    }
+    origin_x = min_x;
+    origin_y = min_y;
+    inverse_cell_size = 1.0f / size;
+
+    // counting sort of the entries by cell
+    size_t num_cells = static_cast<size_t>(columns) * rows;
+    cell_start.assign(num_cells + 1, 0);
+    for (size_t i = 0; i < count; i++) {
+        cell_start[row_of(positions_y[i]) * columns + column_of(positions_x[i]) + 1]++;
+    }
+    for (size_t c = 0; c < num_cells; c++) {
+        cell_start[c + 1] += cell_start[c];
+    }
+
+    cell_entity.resize(count);
+    cell_x.resize(count);
+    cell_y.resize(count);
+    cell_cursor.assign(cell_start.begin(), cell_start.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t slot = cell_cursor[row_of(positions_y[i]) * columns + column_of(positions_x[i])]++;
+        cell_entity[slot] = static_cast<uint32_t>(i);
+        cell_x[slot] = positions_x[i];
+        cell_y[slot] = positions_y[i];
+    }
+}
+
+void SpatialIndex::query_radius(float x, float y, float radius, std::vector<Entity>& out, const std::string& group) const {
+    if (columns == 0) {
+        return;
+    }
+    float radius_squared = radius * radius;
+    int x0 = column_of(x - radius), x1 = column_of(x + radius);
+    int y0 = row_of(y - radius), y1 = row_of(y + radius);
+    for (int row = y0; row <= y1; row++) {
+        for (int column = x0; column <= x1; column++) {
+            uint32_t cell = row * columns + column;
+            for (uint32_t i = cell_start[cell]; i < cell_start[cell + 1]; i++) {
+                float dx = cell_x[i] - x;
+                float dy = cell_y[i] - y;
+                if (dx * dx + dy * dy <= radius_squared && passes_filter(cell_entity[i], group)) {
+                    out.push_back(entities[cell_entity[i]]);
+                }
+            }
+        }
+    }
+}
+
+void SpatialIndex::query_aabb(float min_x, float min_y, float max_x, float max_y, std::vector<Entity>& out, const std::string& group) const {
+    if (columns == 0) {
+        return;
+    }
+    int x0 = column_of(min_x), x1 = column_of(max_x);
+    int y0 = row_of(min_y), y1 = row_of(max_y);
+    for (int row = y0; row <= y1; row++) {
+        for (int column = x0; column <= x1; column++) {
+            uint32_t cell = row * columns + column;
+            for (uint32_t i = cell_start[cell]; i < cell_start[cell + 1]; i++) {
+                bool is_inside = cell_x[i] >= min_x && cell_x[i] <= max_x && cell_y[i] >= min_y && cell_y[i] <= max_y;
+                if (is_inside && passes_filter(cell_entity[i], group)) {
+                    out.push_back(entities[cell_entity[i]]);
+                }
+            }
+        }
+    }
+}
+
+void SpatialIndex::query_nearest_k(float x, float y, size_t k, std::vector<Entity>& out, const std::string& group) const {
+    if (columns == 0 || k == 0) {
+        return;
+    }
+
+    // max-heap of the best k so far, the worst of them on top
+    std::vector<std::pair<float, uint32_t>> best;
+    int center_column = column_of(x);
+    int center_row = row_of(y);
+    float size = 1.0f / inverse_cell_size;
+    int max_ring = std::max(columns, rows);
+
+    // visit the grid in square rings around the query cell, stop once no unvisited ring can beat the worst result
+    for (int ring = 0; ring <= max_ring; ring++) {
+        if (best.size() == k) {
+            float ring_distance = (ring - 1) * size;
+            if (ring_distance > 0 && ring_distance * ring_distance > best.front().first) {
+                break;
+            }
+        }
+        for (int row = center_row - ring; row <= center_row + ring; row++) {
+            if (row < 0 || row >= rows) {
+                continue;
+            }
+            bool is_edge_row = row == center_row - ring || row == center_row + ring;
+            int step = is_edge_row ? 1 : 2 * ring;
+            for (int column = center_column - ring; column <= center_column + ring; column += (step > 0 ? step : 1)) {
+                if (column < 0 || column >= columns) {
+                    continue;
+                }
+                uint32_t cell = row * columns + column;
+                for (uint32_t i = cell_start[cell]; i < cell_start[cell + 1]; i++) {
+                    float dx = cell_x[i] - x;
+                    float dy = cell_y[i] - y;
+                    float distance_squared = dx * dx + dy * dy;
+                    if (best.size() == k && distance_squared >= best.front().first) {
+                        continue;
+                    }
+                    if (!passes_filter(cell_entity[i], group)) {
+                        continue;
+                    }
+                    if (best.size() == k) {
+                        std::pop_heap(best.begin(), best.end());
+                        best.pop_back();
+                    }
+                    best.push_back({distance_squared, cell_entity[i]});
+                    std::push_heap(best.begin(), best.end());
+                }
+            }
+        }
+    }
+
+    std::sort_heap(best.begin(), best.end());
+    for (const auto& entry : best) {
+        out.push_back(entities[entry.second]);
+    }
+}
+
+std::optional<Entity> SpatialIndex::raycast(float x0, float y0, float x1, float y1, float thickness, const std::string& group) const {
+    if (columns == 0) {
+        return std::nullopt;
+    }
+
+    float dir_x = x1 - x0;
+    float dir_y = y1 - y0;
+    float length_squared = dir_x * dir_x + dir_y * dir_y;
+    float thickness_squared = thickness * thickness;
+    float size = 1.0f / inverse_cell_size;
+
+    // cells around the one being walked that can still hold a position within thickness of the ray
+    int reach = static_cast<int>(std::ceil(thickness * inverse_cell_size));
+
+    float best_t = 2.0f;
+    uint32_t best_entry = 0;
+
+    // walk the cells along the segment (Amanatides & Woo)
+    int column = column_of(x0);
+    int row = row_of(y0);
+    int end_column = column_of(x1);
+    int end_row = row_of(y1);
+    int step_x = dir_x > 0 ? 1 : -1;
+    int step_y = dir_y > 0 ? 1 : -1;
+    float delta_x = dir_x != 0 ? std::fabs(size / dir_x) : INFINITY;
+    float delta_y = dir_y != 0 ? std::fabs(size / dir_y) : INFINITY;
+    float next_x = dir_x != 0 ? ((origin_x + (column + (step_x > 0 ? 1 : 0)) * size) - x0) / dir_x : INFINITY;
+    float next_y = dir_y != 0 ? ((origin_y + (row + (step_y > 0 ? 1 : 0)) * size) - y0) / dir_y : INFINITY;
+    float cell_entry_t = 0.0f;
+
+    while (true) {
+        // a hit can't be beaten once the walk is more than a neighbourhood past it
+        if (best_t <= 1.0f && (cell_entry_t - best_t) * std::sqrt(length_squared) > (reach + 1) * size) {
+            break;
+        }
+
+        for (int r = std::max(row - reach, 0); r <= std::min(row + reach, rows - 1); r++) {
+            for (int c = std::max(column - reach, 0); c <= std::min(column + reach, columns - 1); c++) {
+                uint32_t cell = r * columns + c;
+                for (uint32_t i = cell_start[cell]; i < cell_start[cell + 1]; i++) {
+                    // closest point on the segment to this position
+                    float t = length_squared > 0 ? ((cell_x[i] - x0) * dir_x + (cell_y[i] - y0) * dir_y) / length_squared : 0.0f;
+                    t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+                    float dx = x0 + dir_x * t - cell_x[i];
+                    float dy = y0 + dir_y * t - cell_y[i];
+                    if (dx * dx + dy * dy <= thickness_squared && t < best_t && passes_filter(cell_entity[i], group)) {
+                        best_t = t;
+                        best_entry = cell_entity[i];
+                    }
+                }
+            }
+        }
+
+        if (column == end_column && row == end_row) {
+            break;
+        }
+        if (next_x < next_y) {
+            cell_entry_t = next_x;
+            next_x += delta_x;
+            column += step_x;
+        } else {
+            cell_entry_t = next_y;
+            next_y += delta_y;
+            row += step_y;
+        }
+        // the segment left the grid, the border cells were the last ones that could hold anything
+        if (column < 0 || column >= columns || row < 0 || row >= rows || cell_entry_t > 1.0f) {
+            break;
+        }
+    }
+
+    if (best_t <= 1.0f) {
+        return entities[best_entry];
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,82 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "../ecs/ecs.h"
+
+///////////////////////////
+// Spatial Index
+///////////////////////////
+// A uniform grid over entity positions, rebuilt from a fresh snapshot with a
+// counting sort. Answers "what is near this point" by only looking at the
+// cells that can contain an answer, so a query costs roughly the number of
+// results instead of the number of entities.
+// An optional group name restricts the results to entities of that group.
+///////////////////////////
+
+class SpatialIndex {
+    private:
+        float cell_size;
+        float origin_x = 0;
+        float origin_y = 0;
+        float inverse_cell_size = 1;
+        int columns = 0;
+        int rows = 0;
+
+        // everything inserted since the last clear(), in insertion order
+        std::vector<Entity> entities;
+        std::vector<float> positions_x;
+        std::vector<float> positions_y;
+
+        // per cell, sorted by cell: cell_start[c]..cell_start[c + 1] indexes the arrays below
+        std::vector<uint32_t> cell_start;
+        std::vector<uint32_t> cell_entity;
+        std::vector<float> cell_x;
+        std::vector<float> cell_y;
+        std::vector<uint32_t> cell_cursor;
+
+        int column_of(float x) const;
+        int row_of(float y) const;
+        bool passes_filter(uint32_t entry, const std::string& group) const;
+
+    public:
+        SpatialIndex(float cell_size = 128.0f);
+
+        // rebuild the index: clear(), insert() every entity, then build()
+        void clear();
+        void insert(Entity entity, float x, float y);
+        void build();
+
+        size_t size() const {
+            return entities.size();
+        }
+
+        // entities whose position is within radius of (x, y)
+        void query_radius(float x, float y, float radius, std::vector<Entity>& out, const std::string& group = "") const;
+
+        // entities whose position is inside the box
+        void query_aabb(float min_x, float min_y, float max_x, float max_y, std::vector<Entity>& out, const std::string& group = "") const;
+
+        // the k entities closest to (x, y), nearest first
+        void query_nearest_k(float x, float y, size_t k, std::vector<Entity>& out, const std::string& group = "") const;
+
+        // the grid as last built, for the debug overlay
+        int get_columns() const { return columns; }
+        int get_rows() const { return rows; }
+        float get_origin_x() const { return origin_x; }
+        float get_origin_y() const { return origin_y; }
+        // can be bigger than the requested size when the entities are spread far apart
+        float get_cell_world_size() const { return 1.0f / inverse_cell_size; }
+        uint32_t get_cell_count(int column, int row) const {
+            size_t cell = static_cast<size_t>(row) * columns + column;
+            return cell_start[cell + 1] - cell_start[cell];
+        }
+
+        // the first entity along the segment whose position is within thickness of it
+        std::optional<Entity> raycast(float x0, float y0, float x1, float y1, float thickness, const std::string& group = "") const;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define AUDIO_SYSTEM_H
 
 #include "../ecs/ecs.h"
+#include "../profiler/profile_scope.h"
 #include "../components/audio_component.h"
 #include "../asset_store/asset_store.h"
 #include <SDL2/SDL_mixer.h>
@@ -15,6 +16,7 @@ class AudioSystem : public System {
         }
 
         void Update(std::unique_ptr<AssetStore>& asset_store) {
+            PROFILE_SCOPE("AudioSystem::Update");
             int current_time = SDL_GetTicks();
             for (auto entity : get_system_entities()) {
                 
@@ -2,6 +2,7 @@
 #define CAMERA_MOVEMENT_SYSTEM_H
 
 #include "../ecs/ecs.h"
+#include "../profiler/profile_scope.h"
 #include "../components/camera_follow_component.h"
 #include "../components/transform_component.h"
 #include <SDL2/SDL.h>
@@ -15,6 +16,7 @@ class CameraMovementSystem: public System {
         }
 
         void Update(SDL_Rect& camera, int map_width, int map_height) {
+            PROFILE_SCOPE("CameraMovementSystem::Update");
             for (auto entity: get_system_entities()) {
                 auto transform = entity.get_component<TransformComponent>();
 
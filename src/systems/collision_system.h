@@ -2,93 +2,177 @@
 #define COLLISION_SYSTEM_H
 
 #include "../ecs/ecs.h"
+#include "../profiler/profile_scope.h"
 #include "../event_bus/event_bus.h"
-#include "../events/collision_event.h"
+#include "../events/collision_begin_event.h"
+#include "../events/collision_stay_event.h"
+#include "../events/collision_end_event.h"
+#include "../events/tile_collision_event.h"
+#include "../collision/contact_cache.h"
+#include "../collision/broadphase_grid.h"
+#include "../collision/narrowphase.h"
+#include "../jobs/thread_pool.h"
+#include "../tilemap/tile_map.h"
+#include "../debug/debug_draw.h"
 #include "../components/box_collider_component.h"
 #include "../components/transform_component.h"
+#include "../components/rigid_body_component.h"
 #include "../game/game.h"
+#include <algorithm>
 
 class CollisionSystem: public System {
+    private:
+        // pairs that were touching last frame, used to tell begin/stay/end apart
+        ContactCache contacts;
+        uint32_t frame = 0;
+
+        // entity id -> index into this frame's entity list, -1 if the entity left the system
+        std::vector<int> entity_index;
+
+        // per frame collider snapshot, indexed like the entity list
+        BoundsSoA bounds;
+        std::vector<int> entity_ids;
+        std::vector<int> owner_ids;
+        // 1 for colliders with a rigid body, only those are tested against the tile map
+        std::vector<uint8_t> is_moving;
+
+        BroadphaseGrid grid;
+        Narrowphase narrowphase;
+        std::vector<uint64_t> ended_contacts;
+
+        // entity id -> 1 if the entity was overlapping a solid tile last frame
+        std::vector<uint8_t> on_solid_tile;
+
+        // number of colliders handed to a worker at a time for the tile map test
+        static const size_t TILE_TESTS_PER_JOB = 256;
+
     public:
-        CollisionSystem() {
+        // emit a CollisionStayEvent every "stay_interval" frames of sustained contact, 0 disables them
+        int stay_interval;
+
+        CollisionSystem(int stay_interval = 0) {
             require_component<TransformComponent>();
             require_component<BoxColliderComponent>();
+            this->stay_interval = stay_interval;
         }
 
-        glm::vec3 color; 
-        glm::vec3 red = glm::vec3(255.0, 0.0, 0.0);
-        glm::vec3 white = glm::vec3(255.0, 255.0, 255.0);
-
-        bool check_collision(glm::vec2(a_pos), double a_width, double a_height, glm::vec2(b_pos), double b_width, double b_height) {
-            return (
-                a_pos.x < b_pos.x + b_width &&
-                a_pos.x + a_width > b_pos.x &&
-                a_pos.y < b_pos.y + b_height &&
-                a_pos.y + a_height > b_pos.y
-            );
-        }
-
-        void Update(std::unique_ptr<EventBus>& event_bus, bool is_debug) {
+        void Update(std::unique_ptr<EventBus>& event_bus, std::unique_ptr<ThreadPool>& thread_pool, const std::unique_ptr<TileMap>& tile_map, bool is_debug) {
+            PROFILE_SCOPE("CollisionSystem::Update");
             auto entities = get_system_entities();
+            frame++;
+
+            // snapshot the collider bounds on the main thread, the workers never touch the registry
+            bounds.clear();
+            entity_ids.clear();
+            owner_ids.clear();
+            is_moving.clear();
+            std::fill(entity_index.begin(), entity_index.end(), -1);
+            for (size_t i = 0; i < entities.size(); i++) {
+                Entity entity = entities[i];
+                const auto& transform = entity.get_component<TransformComponent>();
+                auto& collider = entity.get_component<BoxColliderComponent>();
 
-            if (is_debug) {
-                for (auto entity: entities) {
-                    auto& collider = entity.get_component<BoxColliderComponent>();
+                if (is_debug) {
                     collider.is_colliding = false;
                 }
-            }
-            
-            for (auto i = entities.begin(); i != entities.end(); i++) {
-                Entity a = *i;
-                auto a_transform = a.get_component<TransformComponent>();
-                auto& a_collider = a.get_component<BoxColliderComponent>();
 
-                for (auto j = i; j != entities.end(); j++) {
-                    Entity b = *j;
+                float x = transform.position.x + collider.offset.x;
+                float y = transform.position.y + collider.offset.y;
+                bounds.push_back({x, y, x + collider.width * transform.scale.x, y + collider.height * transform.scale.y});
+                entity_ids.push_back(entity.get_id());
+                owner_ids.push_back(collider.belongs_to_entity_id);
+                is_moving.push_back(entity.has_component<RigidBodyComponent>());
 
-                    if (a == b) {
+                int id = entity.get_id();
+                if (id >= static_cast<int>(entity_index.size())) {
+                    entity_index.resize(id + 1, -1);
+                }
+                entity_index[id] = static_cast<int>(i);
+            }
+
+            // moving colliders against the tile grid, only the tiles under each box are looked at
+            if (on_solid_tile.size() < entity_index.size()) {
+                on_solid_tile.resize(entity_index.size(), 0);
+            }
+            // each collider is tested by whichever worker gets it, the events go through the bus's
+            // per thread lanes and are merged in collider order at the next sync point
+            thread_pool->parallel_for(entities.size(), TILE_TESTS_PER_JOB, [&](size_t begin, size_t end, size_t thread_index) {
+                for (size_t i = begin; i < end; i++) {
+                    if (!is_moving[i]) {
                         continue;
                     }
+                    int id = entity_ids[i];
+                    const ColliderBounds box = bounds.get(i);
+                    int column = 0;
+                    int row = 0;
+                    bool is_on_solid = tile_map->find_solid(box.min_x, box.min_y, box.max_x, box.max_y, column, row);
+                    if (is_on_solid && !on_solid_tile[id]) {
+                        event_bus->queue_event_from_thread<TileCollisionEvent>(thread_index, i, entities[i], column, row);
+                    }
+                    on_solid_tile[id] = is_on_solid;
+                }
+            });
+            // forget removed entities, so a recycled id starts off the solid tiles
+            for (size_t id = 0; id < on_solid_tile.size(); id++) {
+                if (entity_index[id] == -1) {
+                    on_solid_tile[id] = 0;
+                }
+            }
 
-                    auto b_transform = b.get_component<TransformComponent>();
-                    auto& b_collider = b.get_component<BoxColliderComponent>();
+            grid.build(bounds);
 
-                    if (a_collider.belongs_to_entity_id == b.get_id() || b_collider.belongs_to_entity_id == a.get_id()) {
-                        continue;
-                    }
-                 
-                    bool collision_happened = check_collision(
-                        a_transform.position + a_collider.offset,
-                        a_collider.width * a_transform.scale.x,
-                        a_collider.height * a_transform.scale.y,
-                        b_transform.position + b_collider.offset,
-                        b_collider.width * b_transform.scale.x,
-                        b_collider.height * b_transform.scale.y
-                    );
-
-                    if (collision_happened) {
-                        if (Game::verbose_logging) {
-                            Logger::Log("Entity " + std::to_string(a.get_id()) + " collided with entity " + std::to_string(b.get_id()) + ".");
-                        }
-                        event_bus->emit_event<CollisionEvent>(a, b);
+            // narrowphase, the pairs come back sorted so the events don't depend on the thread count
+            const auto& frame_contacts = narrowphase.find_pairs(*thread_pool, grid, bounds, entity_ids, [&](uint32_t a, uint32_t b) {
+                // projectiles never hit whoever fired them
+                return owner_ids[a] == entity_ids[b] || owner_ids[b] == entity_ids[a];
+            });
+
+            for (uint64_t key : frame_contacts) {
+                Entity a = entities[entity_index[ContactCache::first_id(key)]];
+                Entity b = entities[entity_index[ContactCache::second_id(key)]];
+
+                if (is_debug) {
+                    a.get_component<BoxColliderComponent>().is_colliding = true;
+                    b.get_component<BoxColliderComponent>().is_colliding = true;
+                }
+
+                uint32_t frames_in_contact = contacts.touch(key, frame);
+                if (frames_in_contact == 0) {
+                    if (Game::verbose_logging) {
+                        Logger::Log("Entity " + std::to_string(a.get_id()) + " collided with entity " + std::to_string(b.get_id()) + ".");
                     }
-                    
+                    event_bus->queue_event<CollisionBeginEvent>(a, b);
+                } else if (stay_interval > 0 && frames_in_contact % stay_interval == 0) {
+                    event_bus->queue_event<CollisionStayEvent>(a, b);
                 }
             }
-        }
 
-        // render bounding boxes, using the red color to indicate collision or white to indicate no collision
-        void ColliderDebug(SDL_Renderer* renderer, SDL_Rect& camera) {
-            const auto entities = get_system_entities();
-            for (auto entity: entities) {
-                const auto transform = entity.get_component<TransformComponent>();
-                const auto collider = entity.get_component<BoxColliderComponent>();
-        
-                if (collider.is_colliding) {
-                    color = red;
-                } else {
-                    color = white;
+            // pairs that were not touched this frame have separated
+            ended_contacts.clear();
+            contacts.sweep(frame, [&](uint64_t key) {
+                ended_contacts.push_back(key);
+            });
+            std::sort(ended_contacts.begin(), ended_contacts.end());
+            for (uint64_t key : ended_contacts) {
+                int a_id = ContactCache::first_id(key);
+                int b_id = ContactCache::second_id(key);
+                bool a_alive = a_id < static_cast<int>(entity_index.size()) && entity_index[a_id] != -1;
+                bool b_alive = b_id < static_cast<int>(entity_index.size()) && entity_index[b_id] != -1;
+                // contacts with a killed entity end silently, its components are already gone
+                if (a_alive && b_alive) {
+                    event_bus->queue_event<CollisionEndEvent>(entities[entity_index[a_id]], entities[entity_index[b_id]]);
                 }
+            }
+        }
+
+        // outline the bounding boxes, red while colliding and white otherwise
+        void ColliderDebug(DebugDraw& debug_draw, const SDL_Rect& camera) {
+            PROFILE_SCOPE("CollisionSystem::ColliderDebug");
+            const SDL_Color red = {255, 0, 0, 255};
+            const SDL_Color white = {255, 255, 255, 255};
+            for (auto entity: get_system_entities()) {
+                const auto& transform = entity.get_component<TransformComponent>();
+                const auto& collider = entity.get_component<BoxColliderComponent>();
 
                 SDL_Rect collider_rect = {
                     static_cast<int>(transform.position.x + collider.offset.x - camera.x),
@@ -96,8 +180,7 @@ class CollisionSystem: public System {
                     static_cast<int>(collider.width * transform.scale.x),
                     static_cast<int>(collider.height * transform.scale.y)
                 };
-                SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255.0);
-                SDL_RenderDrawRect(renderer, &collider_rect);
+                debug_draw.rect(collider_rect, collider.is_colliding ? red : white);
             }
         }
 };
@@ -3,7 +3,7 @@
 
 #include "../ecs/ecs.h"
 #include "../event_bus/event_bus.h"
-#include "../events/collision_event.h"
+#include "../events/collision_begin_event.h"
 #include "../components/box_collider_component.h"
 #include "../components/projectile_component.h"
 #include "../components/health_component.h"
@@ -16,10 +16,18 @@ class DamageSystem: public System {
         }
 
         void subscribe_to_events(const std::unique_ptr<EventBus>& event_bus) {
-            event_bus->subscribe_to_event<CollisionEvent>(this, &DamageSystem::on_collision);
+            // damage is dealt once per contact, so only the first frame of a collision matters
+            // the collision events are queued, so the whole frame's worth arrives in one batch
+            event_bus->subscribe_to_event_batch<&DamageSystem::on_collisions>(this);
         }
 
-        void on_collision(CollisionEvent& event) {
+        void on_collisions(EventSpan<CollisionBeginEvent> events) {
+            for (const auto& event : events) {
+                on_collision(event);
+            }
+        }
+
+        void on_collision(const CollisionBeginEvent& event) {
             Entity a = event.a;
             Entity b = event.b;
 
@@ -46,13 +54,6 @@ class DamageSystem: public System {
         //     } else if (b.HasTag("player") && a.BelongsToGroup("enemies")) {
 
         //     }
-
-            // a debugging thing
-            auto& a_collider = a.get_component<BoxColliderComponent>();
-            auto& b_collider = b.get_component<BoxColliderComponent>();
-            a_collider.is_colliding = true;
-            b_collider.is_colliding = true;
-
         }
 
         void on_projectile_hits_player(Entity projectile, Entity player) {
@@ -2,76 +2,84 @@
 #define FOG_OF_WAR_SYSTEM_H
 
 #include "../ecs/ecs.h"
-#include "../components/sprite_component.h"
+#include "../profiler/profile_scope.h"
 #include "../components/transform_component.h"
-#include <glm/glm.hpp>
 #include <SDL2/SDL.h>
-#include "../utils/utils.h"
 #include "../game/game.h"
+#include "../fog/fog_grid.h"
+#include "../debug/debug_draw.h"
 
 // System will be in charge of updating the fog of war
-// If player is in a certain radius of a tile, that tile will be revealed
-// If player is not in a certain radius of a tile, that tile will be hidden upon rendering
+// The fog is a grid over the map, cells within a radius of the player are visible,
+// cells the player has been near stay revealed, see FogGrid
+// Entities don't carry fog state, the render systems look their position up in the grid
 
 class FogOfWarSystem: public System {
-    public:
-        FogOfWarSystem() {
-            require_component<SpriteComponent>();
-        }
+    private:
+        FogGrid grid;
 
-        bool isWithinCircle(float entity_x, float entity_y, float center_x, float center_y, int radius) {
-            float dx = entity_x - center_x;
-            float dy = entity_y - center_y;
-            return (dx * dx + dy * dy) <= (radius * radius);
+    public:
+        FogOfWarSystem(int cell_size = 32): grid(cell_size) {
         }
 
         void Update(std::unique_ptr<Registry>& registry) {
+            PROFILE_SCOPE("FogOfWarSystem::Update");
+            // the grid follows the map, a new level starts fully fogged
+            if (grid.get_columns() == 0 && Game::map_width > 0) {
+                grid.resize(Game::map_width, Game::map_height);
+            }
 
-            
-
-            // get the player entity
-            auto player_group = registry->get_entities_by_group("player");
-            if (player_group.empty()) {
+            // one tag lookup instead of copying the player group every frame
+            Entity player = registry->get_entity_by_tag("player");
+            if (!registry->entity_has_tag(player, "player") || !player.has_component<TransformComponent>()) {
                 return;
-            } else {
-                auto entity = player_group[0];
-                if (entity.HasTag("player")) {
-                    Entity player = entity;
-                    const auto player_transform = player.get_component<TransformComponent>();
-                    // TODO: Center the circle on the player's position, currently using a upper left corner of the player's position
-                    float center_x = player_transform.position.x;
-                    float center_y = player_transform.position.y;
-                    int radius = Game::set_radius;
+            }
+            // TODO: Center the circle on the player's position, currently using a upper left corner of the player's position
+            const auto& player_transform = player.get_component<TransformComponent>();
+            // does nothing until the player crosses into another cell
+            grid.update(player_transform.position.x, player_transform.position.y, Game::set_radius);
+        }
 
-                    for (auto entity: get_system_entities()) {
-                        // all entities with a sprite component will start off hidden until the player is within a certain radius
-                        auto& sprite = entity.get_component<SpriteComponent>();
+        // starts the fog over, e.g. after loading a level
+        void reset(int map_width, int map_height) {
+            grid.resize(map_width, map_height);
+        }
 
-                        // start each frame with the entity hidden
-                        sprite.is_visible = false;
-                        // get the entity's transform component
-                        const auto transform = entity.get_component<TransformComponent>();
+        // drawn over the sprites, darkens what was seen and covers what wasn't
+        void Render(SDL_Renderer* renderer, SDL_Rect& camera) {
+            PROFILE_SCOPE("FogOfWarSystem::Render");
+            grid.Render(renderer, camera);
+        }
 
-                        // get the entity's position
-                        //TODO: Center the circle on the entity's position, currently using a upper left corner of the entity's position
-                        float entity_x = transform.position.x;
-                        float entity_y = transform.position.y;
+        // the overlay texture is gone with the renderer's device
+        void invalidate() {
+            grid.invalidate();
+        }
 
-                        // if the player is within a certain radius of the entity, then reveal the entity
-                        if (Utils::IsWithinCircle(entity_x, entity_y, center_x, center_y, radius)) {
-                            sprite.is_hidden = false;
-                            sprite.is_revealed = true;
-                            sprite.is_visible = true;
-                        } else if (sprite.layer != BACKGROUND_LAYER && sprite.layer != GUI_LAYER && sprite.layer != DECORATION_LAYER) {
-                            sprite.is_hidden = true;
-                        } else if (sprite.layer == GUI_LAYER) {
-                            sprite.is_hidden = false;
-                            sprite.is_visible = true;
-                        }
+        // outlines the visible cells and the reveal circle they were picked with
+        void draw_debug(DebugDraw& debug_draw, const SDL_Rect& camera) {
+            PROFILE_SCOPE("FogOfWarSystem::draw_debug");
+            const SDL_Color cell_color = {255, 255, 0, 60};
+            const SDL_Color radius_color = {255, 255, 0, 200};
+            int size = grid.get_cell_size();
+            const SDL_Rect& area = grid.get_visible_area();
+            for (int row = area.y; row < area.y + area.h; row++) {
+                for (int column = area.x; column < area.x + area.w; column++) {
+                    if (grid.is_cell_visible(column, row)) {
+                        debug_draw.rect({column * size - camera.x, row * size - camera.y, size, size}, cell_color);
                     }
-                } 
+                }
             }
+            if (grid.get_center_column() >= 0) {
+                float center_x = (grid.get_center_column() + 0.5f) * size - camera.x;
+                float center_y = (grid.get_center_row() + 0.5f) * size - camera.y;
+                debug_draw.circle(center_x, center_y, static_cast<float>(Game::set_radius), radius_color, 48);
+            }
+        }
+
+        const FogGrid& get_grid() const {
+            return grid;
         }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -2,6 +2,7 @@
 #define HEALTH_BAR_SYSTEM_H
 
 #include "../ecs/ecs.h"
+#include "../profiler/profile_scope.h"
 #include "../utils/utils.h"
 #include "../components/transform_component.h"
 #include "../components/health_component.h"
@@ -18,6 +19,7 @@ class HealthBarSystem: public System {
         }
 
         void Update() {
+            PROFILE_SCOPE("HealthBarSystem::Update");
             for (auto entity : get_system_entities()) {
                 const auto transform = entity.get_component<TransformComponent>();
                 const auto health = entity.get_component<HealthComponent>();
@@ -0,0 +1,26 @@
+#ifndef HIT_FLASH_SYSTEM_H
+#define HIT_FLASH_SYSTEM_H
+
+#include "../ecs/ecs.h"
+#include "../profiler/profile_scope.h"
+#include "../components/sprite_component.h"
+
+// Counts the hit flash down once per simulation step, so it lasts as long at any render rate.
+class HitFlashSystem: public System {
+    public:
+        HitFlashSystem() {
+            require_component<SpriteComponent>();
+        }
+
+        void Update() {
+            PROFILE_SCOPE("HitFlashSystem::Update");
+            for (auto entity: get_system_entities()) {
+                auto& sprite = entity.get_component<SpriteComponent>();
+                if (sprite.hit_flash > 0) {
+                    sprite.hit_flash--;
+                }
+            }
+        }
+};
+
+#endif
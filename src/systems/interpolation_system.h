@@ -0,0 +1,26 @@
+#ifndef INTERPOLATION_SYSTEM_H
+#define INTERPOLATION_SYSTEM_H
+
+#include "../ecs/ecs.h"
+#include "../profiler/profile_scope.h"
+#include "../components/transform_component.h"
+
+// Remembers where every entity starts the fixed step, whatever moves it afterwards (rigid bodies,
+// collision responses, Lua set_position), so the renderer can blend from there to the new position.
+// Runs first in the step, a teleport snaps previous_position itself after this.
+class InterpolationSystem: public System {
+    public:
+        InterpolationSystem() {
+            require_component<TransformComponent>();
+        }
+
+        void Update() {
+            PROFILE_SCOPE("InterpolationSystem::Update");
+            for (auto entity: get_system_entities()) {
+                auto& transform = entity.get_component<TransformComponent>();
+                transform.previous_position = transform.position;
+            }
+        }
+};
+
+#endif
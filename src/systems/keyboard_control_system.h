@@ -17,7 +17,7 @@ class KeyboardControlSystem: public System {
         }
 
         void subscribe_to_events(std::unique_ptr<EventBus>& event_bus) {
-            event_bus->subscribe_to_event<KeyPressedEvent>(this, &KeyboardControlSystem::on_key_pressed);
+            event_bus->subscribe_to_event<&KeyboardControlSystem::on_key_pressed>(this);
         }
 
         void on_key_pressed(KeyPressedEvent& event) {
@@ -2,12 +2,14 @@
 #define MOVEMENT_SYSTEM_H
 
 #include "../ecs/ecs.h"
+#include "../profiler/profile_scope.h"
 #include "../components/transform_component.h"
 #include "../components/rigid_body_component.h"
 #include "../components/sprite_component.h"
 #include "../logger/logger.h"
 #include "../event_bus/event_bus.h"
-#include "../events/collision_event.h"
+#include "../events/collision_begin_event.h"
+#include "../events/tile_collision_event.h"
 #include <SDL2/SDL.h>
 #include "../utils/utils.h"
 
@@ -19,10 +21,11 @@ class MovementSystem: public System {
         }
 
         void subscribe_to_events(const std::unique_ptr<EventBus>& event_bus) {
-            event_bus->subscribe_to_event<CollisionEvent>(this, &MovementSystem::on_collision);
+            event_bus->subscribe_to_event<&MovementSystem::on_collision>(this);
+            event_bus->subscribe_to_event<&MovementSystem::on_tile_collision>(this);
         }
 
-        void on_collision(CollisionEvent& event) {
+        void on_collision(CollisionBeginEvent& event) {
             Entity a = event.a;
             Entity b = event.b;
 
@@ -33,7 +36,18 @@ class MovementSystem: public System {
             }
         }
 
+        // solid tiles turn enemies around the same way obstacle entities do
+        void on_tile_collision(TileCollisionEvent& event) {
+            if (event.entity.BelongsToGroup("enemies")) {
+                bounce(event.entity);
+            }
+        }
+
         void on_enemy_hits_obstacle(Entity enemy, Entity obstacle) {
+            bounce(enemy);
+        }
+
+        void bounce(Entity enemy) {
             if (!enemy.has_component<RigidBodyComponent>() || !enemy.has_component<SpriteComponent>()) {
                 return;
             }
@@ -52,6 +66,7 @@ class MovementSystem: public System {
         }
 
         void Update(float delta_time, int map_width, int map_height) {
+            PROFILE_SCOPE("MovementSystem::Update");
             for (auto entity: get_system_entities()) {
                 auto& transform = entity.get_component<TransformComponent>();
                 const auto sprite = entity.get_component<SpriteComponent>();
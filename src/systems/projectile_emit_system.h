@@ -2,6 +2,7 @@
 #define PROJECTILE_EMIT_SYSTEM_H
 
 #include "../ecs/ecs.h"
+#include "../profiler/profile_scope.h"
 #include "../components/projectile_emitter_component.h"
 #include "../components/transform_component.h"
 #include "../components/rigid_body_component.h"
@@ -10,6 +11,7 @@
 #include "../components/projectile_component.h"
 #include "../components/camera_follow_component.h"
 #include "../components/audio_component.h"
+#include "../timing/clock.h"
 #include <SDL2/SDL.h>
 
 class ProjectileEmitSystem: public System {
@@ -21,7 +23,7 @@ class ProjectileEmitSystem: public System {
 
         void subscribe_to_events(std::unique_ptr<EventBus>& event_bus) {
             // subscribe to the event of the space key being pressed
-            event_bus->subscribe_to_event<KeyPressedEvent>(this, &ProjectileEmitSystem::on_key_pressed);
+            event_bus->subscribe_to_event<&ProjectileEmitSystem::on_key_pressed>(this);
         }
 
         void on_key_pressed(KeyPressedEvent& event) {
@@ -59,6 +61,7 @@ class ProjectileEmitSystem: public System {
         }
 
         void Update(std::unique_ptr<Registry>& registry) {
+            PROFILE_SCOPE("ProjectileEmitSystem::Update");
             for (auto entity: get_system_entities()) {
                 auto& projectile_emitter = entity.get_component<ProjectileEmitterComponent>();
                 const auto transform = entity.get_component<TransformComponent>();
@@ -66,7 +69,7 @@ class ProjectileEmitSystem: public System {
                 if (projectile_emitter.repeat_frequency == 0) continue;
   
                 // check if its time to re-emit a new projectile
-                if (SDL_GetTicks() - projectile_emitter.last_emission_time > projectile_emitter.repeat_frequency) {
+                if (Clock::get_ticks() - projectile_emitter.last_emission_time > projectile_emitter.repeat_frequency) {
                     glm::vec2 projectile_position = transform.position;
                     if (entity.has_component<SpriteComponent>()) {
                         const auto sprite = entity.get_component<SpriteComponent>();
@@ -78,7 +81,7 @@ class ProjectileEmitSystem: public System {
                     projectile_do(projectile, projectile_position, projectile_emitter.projectile_velocity, projectile_emitter.is_friendly, projectile_emitter.hit_damage, projectile_emitter.projectile_duration, entity_id);
                     
                     // update the last emission time
-                    projectile_emitter.last_emission_time = SDL_GetTicks();
+                    projectile_emitter.last_emission_time = Clock::get_ticks();
                 }
             }
         }
@@ -2,8 +2,10 @@
 #define PROJECTILE_LIFECYCLE_SYSTEM_H
 
 #include "../ecs/ecs.h"
+#include "../profiler/profile_scope.h"
 #include "../components/projectile_component.h"
 #include "../components/transform_component.h"
+#include "../timing/clock.h"
 #include <SDL2/SDL.h>
 
 class ProjectileLifecycleSystem: public System {
@@ -14,6 +16,7 @@ class ProjectileLifecycleSystem: public System {
         }
 
         void Update(SDL_Rect& camera) {
+            PROFILE_SCOPE("ProjectileLifecycleSystem::Update");
             
             for (auto entity: get_system_entities()) {
                 auto projectile = entity.get_component<ProjectileComponent>();
@@ -26,7 +29,7 @@ class ProjectileLifecycleSystem: public System {
                     entity.Kill();
                 }
 
-                if (SDL_GetTicks() - projectile.start_time > projectile.duration) {
+                if (Clock::get_ticks() - projectile.start_time > projectile.duration) {
                     entity.Kill();
                 }
             }
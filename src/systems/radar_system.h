@@ -2,79 +2,124 @@
 #define RADAR_SYSTEM_H
 
 #include "../ecs/ecs.h"
+#include "../profiler/profile_scope.h"
 #include "../components/transform_component.h"
 #include "../components/sprite_component.h"
 #include "../components/health_component.h"
 #include "../utils/utils.h"
 #include <SDL2/SDL.h>
 #include "../game/game.h"
+#include "../spatial/spatial_index.h"
+#include "../logger/logger.h"
 
 class RadarSystem: public System {
     // TODO: Implement radar system
     // Basically a mini map that shows the player's position and the position of nearby enemies
     // Reuse fog of war system code to only show enemies that are within a certain radius of the player
 
+    private:
+        // entities within the detection radius, kept around so its capacity is reused
+        std::vector<Entity> detected_entities;
+        // one square per detected entity, drawn in a single call
+        std::vector<SDL_Rect> blips;
+
+        // the blips are drawn into this texture at the refresh rate and it is copied to the screen every frame
+        SDL_Texture* radar_texture = nullptr;
+        Uint32 last_refresh = 0;
+        int refresh_rate;
+
+        static const int RADAR_SIZE = 64; // radar radius from center in pixels
+        static const int RADAR_STARTING_X = 10;
+        static const int RADAR_STARTING_Y = 10;
+        static const int BLIP_SIZE = 4;
+
+        void refresh(SDL_Renderer* renderer, std::unique_ptr<Registry>& registry, SpatialIndex& spatial_index) {
+            float detection_radius = 200.0f;  // radar detection_radius in pixels
+            float scale_x = (RADAR_SIZE / detection_radius) * (Game::map_width / Game::window_width);
+            float scale_y = (RADAR_SIZE / detection_radius) * (Game::map_height / Game::window_height);
+            // in texture coordinates, the texture is the radar's square
+            float radar_center_x = RADAR_SIZE;
+            float radar_center_y = RADAR_SIZE;
+
+            blips.clear();
+            Entity player = registry->get_entity_by_tag("player");
+            if (registry->entity_has_tag(player, "player")) {
+                const auto player_position = player.get_component<TransformComponent>().position;
+
+                // get all the enemies within a detection_radius of the player
+                detected_entities.clear();
+                spatial_index.query_radius(player_position.x, player_position.y, detection_radius, detected_entities);
+                for (auto entity: detected_entities) {
+                    // only entities with health show up on the radar
+                    if (entity == player || !entity.has_component<HealthComponent>() || !entity.has_component<SpriteComponent>()) {
+                        continue;
+                    }
+                    const auto entity_position = entity.get_component<TransformComponent>().position;
+
+                    int relative_x = static_cast<int>((entity_position.x - player_position.x) * scale_x);
+                    int relative_y = static_cast<int>((entity_position.y - player_position.y) * scale_y);
+
+                    // translate to radar coordinates
+                    int dot_x = radar_center_x + relative_x;
+                    int dot_y = radar_center_y + relative_y;
+                    blips.push_back({dot_x - BLIP_SIZE / 2, dot_y - BLIP_SIZE / 2, BLIP_SIZE, BLIP_SIZE});
+                }
+            }
+
+            SDL_Texture* previous_target = SDL_GetRenderTarget(renderer);
+            SDL_SetRenderTarget(renderer, radar_texture);
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+            SDL_RenderClear(renderer);
+            if (!blips.empty()) {
+                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+                SDL_RenderFillRects(renderer, blips.data(), static_cast<int>(blips.size()));
+            }
+            SDL_SetRenderTarget(renderer, previous_target);
+        }
+
     public:
-        RadarSystem() {
+        // refresh_rate is how many times a second the blips are redrawn, 0 redraws every frame
+        RadarSystem(int refresh_rate = 10) {
             require_component<TransformComponent>();
             require_component<SpriteComponent>();
             require_component<HealthComponent>();
+            this->refresh_rate = refresh_rate;
         }
 
-        
+        ~RadarSystem() {
+            invalidate();
+        }
 
-        void Render(SDL_Renderer* renderer, std::unique_ptr<Registry>& registry) {
-            float radar_size = 64.0f; // radar radius from center in pixels
-            int radar_starting_x = 10;
-            int radar_starting_y = 10;
-            float detection_radius = 200.0f;  // radar detection_radius in pixels
-            float scale_x = (radar_size / detection_radius) * (Game::map_width / Game::window_width);
-            float scale_y = (radar_size / detection_radius) * (Game::map_height / Game::window_height);
-            float radar_center_x = radar_size + radar_starting_x;
-            float radar_center_y = radar_size + radar_starting_y;
-
-            auto player_group = registry->get_entities_by_group("player");
-            if (player_group.empty()) {
-                return;
-            } else {
-                auto entity = player_group[0];
-                if (entity.HasTag("player")) {
-                    Entity player = entity;
-                    const auto player_transform = player.get_component<TransformComponent>();
-                    const auto player_position = player_transform.position;
-
-                    // get all the enemies within a detection_radius of the player
-                    for (auto entity: get_system_entities()) {
-                        const auto transform = entity.get_component<TransformComponent>();
-                        const auto entity_position = transform.position;
-
-                        if (Utils::IsWithinCircle(entity_position.x, entity_position.y, player_position.x, player_position.y, static_cast<int>(detection_radius))) {
-                            
-                            if (entity.HasTag("player")) {
-                                continue;
-                            }
-
-                            int relative_x = static_cast<int>((entity_position.x - player_position.x) * scale_x);
-                            int relative_y = static_cast<int>((entity_position.y - player_position.y) * scale_y);
-
-                            // translate to radar coordinates
-                            int dot_x = radar_center_x + relative_x;
-                            int dot_y = radar_center_y + relative_y;
-
-                            SDL_Rect rect;
-                            int square_size = 4;
-                            rect.x = dot_x - square_size / 2;
-                            rect.y = dot_y - square_size / 2;
-                            rect.w = square_size;
-                            rect.h = square_size;
-
-                            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-                            SDL_RenderFillRect(renderer, &rect);
-                        }
-                    }
+        // drops the radar texture, needed when the renderer loses its targets
+        void invalidate() {
+            if (radar_texture) {
+                SDL_DestroyTexture(radar_texture);
+                radar_texture = nullptr;
+            }
+        }
+
+        void Render(SDL_Renderer* renderer, std::unique_ptr<Registry>& registry, SpatialIndex& spatial_index) {
+            PROFILE_SCOPE("RadarSystem::Render");
+            bool is_new_texture = false;
+            if (!radar_texture) {
+                radar_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, 2 * RADAR_SIZE, 2 * RADAR_SIZE);
+                if (!radar_texture) {
+                    Logger::Err("Failed to create radar texture: " + std::string(SDL_GetError()));
+                    return;
                 }
+                SDL_SetTextureBlendMode(radar_texture, SDL_BLENDMODE_BLEND);
+                is_new_texture = true;
             }
+
+            Uint32 now = SDL_GetTicks();
+            if (is_new_texture || refresh_rate <= 0 || now - last_refresh >= 1000u / refresh_rate) {
+                refresh(renderer, registry, spatial_index);
+                last_refresh = now;
+            }
+
+            SDL_Rect dst_rect = {RADAR_STARTING_X, RADAR_STARTING_Y, 2 * RADAR_SIZE, 2 * RADAR_SIZE};
+            SDL_RenderCopy(renderer, radar_texture, NULL, &dst_rect);
         }
 };
 
-#endif 
\ No newline at end of file
+#endif
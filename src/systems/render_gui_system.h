@@ -2,23 +2,32 @@
 #define RENDER_GUI_SYSTEM_H
 
 #include "../ecs/ecs.h"
+#include "../profiler/profiler.h"
 #include <imgui/imgui.h>
 #include <imgui/imgui_sdl.h>
 #include "../logger/logger.h"
 #include "../utils/utils.h"
 #include <SDL2/SDL.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
 #include "../game/game.h"
+#include "../renderer/sprite_batch.h"
+#include "../renderer/text_cache.h"
+#include "../timing/frame_pacer.h"
 
 class RenderGUISystem: public System {
     public:
         RenderGUISystem() = default;
 
-        void Render(std::unique_ptr<Registry>& registry, SDL_Rect& camera, int map_width, int map_height) {
+        void Render(std::unique_ptr<Registry>& registry, SDL_Rect& camera, int map_width, int map_height, const RenderStats& render_stats, const TextCacheStats& text_stats, const FrameStats& frame_stats) {
+            PROFILE_SCOPE("RenderGUISystem::Render");
             ImGui::NewFrame();
             static bool is_debug = true;
             static bool is_console_log = true;
             static bool enemy_spawn_tool = false;
             static bool player_settings = true;
+            static bool profiler_view = true;
 
             if (ImGui::BeginMainMenuBar()) {
                 
@@ -35,6 +44,7 @@ class RenderGUISystem: public System {
                     if (ImGui::MenuItem("Toggle Player Settings", "Cmd+P", &player_settings, true)) {
                         
                     }
+                    ImGui::MenuItem("Toggle Profiler", nullptr, &profiler_view, true);
                     ImGui::EndMenu();
                 }
                 ImGui::EndMainMenuBar();
@@ -43,6 +53,15 @@ class RenderGUISystem: public System {
             if (is_debug) {
                 if (ImGui::Begin("Debug Panel")) {
                     ImGui::Text("FPS: %d", Utils::GetFPS());
+                    ImGui::Text("Frame Time: %.2f ms avg, %.2f ms target", frame_stats.average_ms, frame_stats.target_ms);
+                    ImGui::Text("Frame Time: %.2f min, %.2f max, %.2f p99 (ms)", frame_stats.min_ms, frame_stats.max_ms, frame_stats.p99_ms);
+                    ImGui::Text("Frame Jitter: %.2f min, %.2f max, %.2f p99 (ms)", frame_stats.jitter_min_ms, frame_stats.jitter_max_ms, frame_stats.jitter_p99_ms);
+                    ImGui::Text("Sprites: %d", render_stats.sprites);
+                    ImGui::Text("Sprite Batches: %d", render_stats.batches);
+                    ImGui::Text("Draw Calls: %d", render_stats.draw_calls);
+                    ImGui::Text("Atlas Pages: %d (%.0f%% used)", render_stats.atlas_pages, render_stats.atlas_occupancy * 100.0f);
+                    ImGui::Text("Text Cache: %d hits, %d misses, %d evicted", text_stats.hits, text_stats.misses, text_stats.evictions);
+                    ImGui::Text("Text Cache Size: %d entries, %d / %d KB", text_stats.entries, static_cast<int>(text_stats.bytes / 1024), static_cast<int>(text_stats.budget / 1024));
                     ImGui::Separator();
                     // get mouse position from imgui
                     ImGuiIO& io = ImGui::GetIO();
@@ -280,6 +299,7 @@ class RenderGUISystem: public System {
                             ImGui::SliderFloat("Y", &player_position.y, 0.0f, static_cast<float>(map_height - sprite.height * transform.scale.y));
                             if (ImGui::Button("Set Player Position")) {
                                 transform.position = player_position;
+                                transform.previous_position = player_position;
                                 camera.x = transform.position.x - (camera.w / 2);
                                 camera.y = transform.position.y - (camera.h / 2);
                                 camera.x = camera.x < 0 ? 0 : camera.x;
@@ -292,10 +312,91 @@ class RenderGUISystem: public System {
                     }
                 }
             }
+            if (profiler_view) {
+                render_profiler();
+            }
             ImGui::Render();
             ImGuiSDL::Render(ImGui::GetDrawData());
         }
 
+        // the previous frame as a timeline, a row per thread and nesting level, and every scope's recent history
+        void render_profiler() {
+            if (!ImGui::Begin("Profiler")) {
+                ImGui::End();
+                return;
+            }
+            if (!Profiler::is_enabled()) {
+                ImGui::Text("Built without ENABLE_PROFILER.");
+                ImGui::End();
+                return;
+            }
+            const FrameProfile& profile = Profiler::get_frame_profile();
+            ImGui::Text("Frame: %.2f ms, %d threads", profile.frame_ms, profile.thread_count);
+            bool has_allocations = AllocationTracker::is_enabled();
+            if (has_allocations) {
+                ImGui::Text("Allocations: %d (%d KB), %d frees", static_cast<int>(profile.allocations), static_cast<int>(profile.allocated_bytes / 1024), static_cast<int>(profile.frees));
+            }
+
+            // rows per thread, deep enough for its most nested scope
+            std::vector<int> row_offsets(profile.thread_count + 1, 0);
+            for (const auto& marker : profile.markers) {
+                row_offsets[marker.thread + 1] = std::max(row_offsets[marker.thread + 1], marker.depth + 1);
+            }
+            for (int i = 1; i <= profile.thread_count; i++) {
+                row_offsets[i] += row_offsets[i - 1];
+            }
+            const float row_height = 18.0f;
+            ImVec2 origin = ImGui::GetCursorScreenPos();
+            float width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+            float height = row_offsets[profile.thread_count] * row_height;
+            float ms_to_pixels = profile.frame_ms > 0 ? width / profile.frame_ms : 0;
+
+            ImDrawList* draw_list = ImGui::GetWindowDrawList();
+            draw_list->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + height), IM_COL32(30, 30, 30, 255));
+            ImVec2 mouse = ImGui::GetIO().MousePos;
+            for (const auto& marker : profile.markers) {
+                float y = origin.y + (row_offsets[marker.thread] + marker.depth) * row_height;
+                ImVec2 min(origin.x + marker.start_ms * ms_to_pixels, y);
+                ImVec2 max(std::max(origin.x + marker.end_ms * ms_to_pixels, min.x + 1.0f), y + row_height - 1.0f);
+                draw_list->AddRectFilled(min, max, scope_color(marker.name));
+                if (max.x - min.x > 40.0f) {
+                    draw_list->PushClipRect(min, max, true);
+                    draw_list->AddText(ImVec2(min.x + 2.0f, min.y + 2.0f), IM_COL32(0, 0, 0, 255), marker.name);
+                    draw_list->PopClipRect();
+                }
+                if (mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y) {
+                    ImGui::SetTooltip("%s\nthread %d, %.3f ms", marker.name, marker.thread, marker.end_ms - marker.start_ms);
+                }
+            }
+            ImGui::Dummy(ImVec2(width, height));
+
+            ImGui::Separator();
+            for (size_t i = 0; i < profile.scopes.size(); i++) {
+                const ProfileScopeStats& scope = profile.scopes[i];
+                char overlay[96];
+                if (has_allocations) {
+                    snprintf(overlay, sizeof(overlay), "%.2f avg %.2f max (ms), %d allocs", scope.average_ms, scope.max_ms, static_cast<int>(scope.last_allocations));
+                } else {
+                    snprintf(overlay, sizeof(overlay), "%.2f avg %.2f max (ms)", scope.average_ms, scope.max_ms);
+                }
+                ImGui::PushID(static_cast<int>(i));
+                ImGui::Text("%s", scope.name);
+                ImGui::SameLine(240.0f);
+                ImGui::PlotHistogram("##history", scope.history.data(), Profiler::HISTORY_SIZE, profile.history_offset, overlay, 0.0f, std::max(scope.max_ms, 0.01f), ImVec2(0, 24));
+                ImGui::PopID();
+            }
+            ImGui::End();
+        }
+
+        // a stable color per scope name
+        static ImU32 scope_color(const char* name) {
+            uint32_t hash = 2166136261u;
+            for (const char* c = name; *c; c++) {
+                hash = (hash ^ static_cast<unsigned char>(*c)) * 16777619u;
+            }
+            return IM_COL32(120 + (hash & 0x7f), 120 + ((hash >> 8) & 0x7f), 120 + ((hash >> 16) & 0x7f), 255);
+        }
+
         glm::vec2 get_player_angle(std::unique_ptr<Registry>& registry, glm::vec2 enemy_position) {
             auto player = registry->get_entity_by_tag("player");
             if (player.BelongsToGroup("player")) {
@@ -2,100 +2,90 @@
 #define RENDER_SYSTEM_H
 
 #include "../ecs/ecs.h"
+#include "../profiler/profile_scope.h"
 #include "../components/transform_component.h"
 #include "../components/sprite_component.h"
 #include "../asset_store/asset_store.h"
+#include "../renderer/sprite_batch.h"
+#include "../fog/fog_grid.h"
 #include <SDL2/SDL.h>
 
 class RenderSystem: public System {
+    private:
+        SpriteBatch sprite_batch;
+
     public:
         RenderSystem() {
             require_component<TransformComponent>();
             require_component<SpriteComponent>();
         }
 
-        void Render(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& asset_store, SDL_Rect& camera) {
-            struct RenderableEntity {
-                TransformComponent transform_component;
-                SpriteComponent sprite_component;
-            };
-            
-            std::map<SpriteLayer, std::vector<RenderableEntity>> layer_map;
+        const RenderStats& get_render_stats() const {
+            return sprite_batch.get_stats();
+        }
+
+        // interpolation is how far the frame is between the last two simulation steps, 0 to 1
+        void Render(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& asset_store, SDL_Rect& camera, const FogGrid& fog, float interpolation) {
+            PROFILE_SCOPE("RenderSystem::Render");
+            sprite_batch.begin(*asset_store);
 
             for (auto entity : get_system_entities()) {
-                // Terrible code that will be refactored later maybe
                 auto& sprite = entity.get_component<SpriteComponent>();
-                if (sprite.hit_flash > 0) {
-                        sprite.hit_flash -= 1;
-                }
-                RenderableEntity renderable_entity;
-                renderable_entity.transform_component = entity.get_component<TransformComponent>();
-                renderable_entity.sprite_component = entity.get_component<SpriteComponent>();
+                const auto& transform = entity.get_component<TransformComponent>();
+                const glm::vec2 position = transform.previous_position + (transform.position - transform.previous_position) * interpolation;
 
-                
                 bool is_entity_outside_camera_view = (
-                    renderable_entity.transform_component.position.x + (renderable_entity.transform_component.scale.x * renderable_entity.sprite_component.width) < camera.x ||
-                    renderable_entity.transform_component.position.x - (renderable_entity.transform_component.scale.x * renderable_entity.sprite_component.width) > camera.x + camera.w ||
-                    renderable_entity.transform_component.position.y + (renderable_entity.transform_component.scale.y * renderable_entity.sprite_component.height) < camera.y ||
-                    renderable_entity.transform_component.position.y - (renderable_entity.transform_component.scale.y * renderable_entity.sprite_component.height) > camera.y + camera.h
+                    position.x + (transform.scale.x * sprite.width) < camera.x ||
+                    position.x - (transform.scale.x * sprite.width) > camera.x + camera.w ||
+                    position.y + (transform.scale.y * sprite.height) < camera.y ||
+                    position.y - (transform.scale.y * sprite.height) > camera.y + camera.h
                 );
 
                 // cull entities that are off screen (and are not fixed)
-                if (is_entity_outside_camera_view and !renderable_entity.sprite_component.is_fixed) {
+                if (is_entity_outside_camera_view and !sprite.is_fixed) {
                     continue;
                 }
 
-                // fog of war system will hide entities that are not within a certain radius of the player
-                if (renderable_entity.sprite_component.is_hidden) {
-                    continue;
+                // fog of war, sprites out of the player's sight are looked up in the fog grid
+                if (sprite.is_hidden && !sprite.is_fixed) {
+                    float center_x = position.x + sprite.width * transform.scale.x * 0.5f;
+                    float center_y = position.y + sprite.height * transform.scale.y * 0.5f;
+                    if (!fog.is_visible(center_x, center_y)) {
+                        // scenery that was seen once stays, the fog overlay darkens it, anything else is hidden
+                        bool is_scenery = sprite.layer == BACKGROUND_LAYER || sprite.layer == DECORATION_LAYER;
+                        if (!is_scenery || !fog.is_revealed(center_x, center_y)) {
+                            continue;
+                        }
+                    }
                 }
 
-                layer_map[renderable_entity.sprite_component.layer].emplace_back(renderable_entity);
-            }
-
-            for (const auto& [layer, entities] : layer_map) {
-                for (const auto& entity : entities) {
-                    const auto transform = entity.transform_component;
-                    const auto sprite = entity.sprite_component;
-
-                    SDL_Texture* baseTexture = asset_store->get_texture(sprite.asset_id);
+                // snapped to whole pixels like before, so neighbouring tiles don't leave seams
+                SDL_FRect dst_rect = {
+                    static_cast<float>(static_cast<int>(position.x - (sprite.is_fixed ? 0 : camera.x))),
+                    static_cast<float>(static_cast<int>(position.y - (sprite.is_fixed ? 0 : camera.y))),
+                    static_cast<float>(static_cast<int>(sprite.width * transform.scale.x)),
+                    static_cast<float>(static_cast<int>(sprite.height * transform.scale.y))
+                };
 
-                    // use a white texture if the sprite is hit_flashing
-                    SDL_Texture* whiteTexture = nullptr;
-                    if (sprite.hit_flash > 0) {
-                        std::string white_id = sprite.asset_id + "_white";
-                        whiteTexture = asset_store->get_texture(white_id);
-                    }
+                SDL_Color color = {255, 255, 255, 255};
 
-                    SDL_Rect src_rect = sprite.src_rect;
-                    SDL_Rect dst_rect = {
-                        static_cast<int>(transform.position.x - (sprite.is_fixed ? 0 : camera.x)),
-                        static_cast<int>(transform.position.y - (sprite.is_fixed ? 0 : camera.y)),
-                        static_cast<int>(sprite.width * transform.scale.x),
-                        static_cast<int>(sprite.height * transform.scale.y)
-                    };
-
-                    // fog of war system, that will fade out entities that are not within a certain radius of the player
-                    // but have already been revealed by the player
-                    if (sprite.is_revealed) {
-                        if (sprite.is_visible) {
-                            SDL_SetTextureAlphaMod(baseTexture, 255);
-                        } else {
-                            SDL_SetTextureAlphaMod(baseTexture, 100);
-                        }
-                    }
-                    
-                    SDL_RenderCopyEx(renderer, baseTexture, &src_rect, &dst_rect, transform.rotation, NULL, sprite.flip);
+                // look the handles up once, the string ids are not touched again after that
+                if (sprite.texture_handle < 0) {
+                    sprite.texture_handle = asset_store->get_texture_handle(sprite.asset_id);
+                }
+                sprite_batch.draw(sprite.texture_handle, sprite.src_rect, dst_rect, transform.rotation, sprite.flip, color, sprite.layer);
 
-                    if (whiteTexture != nullptr) {
-                        int alpha = 175;
-                        SDL_SetTextureColorMod(whiteTexture, 255, 128, 128);
-                        SDL_SetTextureAlphaMod(whiteTexture, alpha);
-                        SDL_RenderCopyEx(renderer, whiteTexture, &src_rect, &dst_rect, transform.rotation, NULL, sprite.flip);
-                        SDL_SetTextureAlphaMod(whiteTexture, 255);
+                // use a tinted white texture on top if the sprite is hit_flashing
+                // submitted right after the sprite, so it lands directly above it and below anything drawn later
+                if (sprite.hit_flash > 0) {
+                    if (sprite.white_texture_handle < 0) {
+                        sprite.white_texture_handle = asset_store->get_texture_handle(sprite.asset_id + "_white");
                     }
+                    sprite_batch.draw(sprite.white_texture_handle, sprite.src_rect, dst_rect, transform.rotation, sprite.flip, {255, 128, 128, 175}, sprite.layer);
                 }
             }
+
+            sprite_batch.flush(renderer);
         }    
 };
 
@@ -4,61 +4,118 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include "../ecs/ecs.h"
+#include "../profiler/profile_scope.h"
 #include "../components/text_label_component.h"
-#include "../components/transform_component.h"
 #include "../components/sprite_component.h"
+#include "../components/transform_component.h"
+#include "../asset_store/asset_store.h"
+#include "../renderer/sprite_batch.h"
+#include "../renderer/text_cache.h"
+#include "../fog/fog_grid.h"
 
 class RenderTextSystem: public System {
+    private:
+        // ASCII labels are laid out from the fonts' glyph atlases and drawn as batched quads
+        SpriteBatch glyph_batch;
+        // anything the glyph atlases can't draw is rasterised by SDL_ttf and cached
+        TextCache text_cache;
+
     public:
-        RenderTextSystem() {
+        RenderTextSystem(size_t cache_budget_bytes = 4 * 1024 * 1024): text_cache(cache_budget_bytes) {
             require_component<TextLabelComponent>();
         }
 
-        void Render(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& asset_store, SDL_Rect& camera) {
+        void Render(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& asset_store, SDL_Rect& camera, const FogGrid& fog, float interpolation) {
+            PROFILE_SCOPE("RenderTextSystem::Render");
+            glyph_batch.begin(*asset_store);
             for (auto entity: get_system_entities()) {
-                const auto text_label = entity.get_component<TextLabelComponent>();
-                const auto transform = entity.get_component<TransformComponent>();
+                const auto& text_label = entity.get_component<TextLabelComponent>();
 
+                // labels that follow an entity, like health bars, are hidden with it by the fog of war
+                // and drawn where the entity is drawn, between its last two simulation steps
+                glm::vec2 follow_offset = glm::vec2(0);
                 if (text_label.belongs_to_entity_id != -1) {
-                    const auto sprite = entity.get_component<SpriteComponent>();
-                    if (sprite.is_hidden) {
+                    const auto& sprite = entity.get_component<SpriteComponent>();
+                    const auto& transform = entity.get_component<TransformComponent>();
+                    follow_offset = (transform.previous_position - transform.position) * (1.0f - interpolation);
+                    float center_x = transform.position.x + sprite.width * transform.scale.x * 0.5f;
+                    float center_y = transform.position.y + sprite.height * transform.scale.y * 0.5f;
+                    if (sprite.is_hidden && !fog.is_visible(center_x, center_y)) {
                         continue;
                     }
                 }
 
-                TTF_Font* font_id = asset_store->get_font(text_label.asset_id);
-
-                SDL_Surface* surface = TTF_RenderText_Blended(font_id, text_label.text.c_str(), text_label.color);
-                SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-                SDL_FreeSurface(surface);
+                const GlyphAtlas* glyph_atlas = asset_store->get_glyph_atlas(text_label.asset_id);
+                bool use_glyphs = glyph_atlas != nullptr && GlyphAtlas::can_draw(text_label.text);
+                TTF_Font* font = nullptr;
 
+                // the size comes from the glyph metrics, the cache, or from laying the text out without
+                // rasterising it, so labels outside the camera never reach TTF_RenderText_Blended
                 int label_width = 0;
                 int label_height = 0;
-                SDL_QueryTexture(texture, NULL, NULL, &label_width, &label_height);
+                if (use_glyphs) {
+                    label_width = glyph_atlas->measure(text_label.text);
+                    label_height = glyph_atlas->get_line_height();
+                } else if (!text_cache.find(text_label.asset_id, text_label.text, text_label.color, label_width, label_height)) {
+                    font = asset_store->get_font(text_label.asset_id);
+                    if (font == nullptr || TTF_SizeText(font, text_label.text.c_str(), &label_width, &label_height) != 0) {
+                        continue;
+                    }
+                }
+
+                SDL_Rect dst_rect = {
+                    static_cast<int>(text_label.position.x + follow_offset.x - (text_label.is_fixed ? 0 : camera.x)),
+                    static_cast<int>(text_label.position.y + follow_offset.y - (text_label.is_fixed ? 0 : camera.y)),
+                    label_width,
+                    label_height
+                };
 
                 bool is_text_outside_camera_view = (
-                    transform.position.x + (transform.scale.x * label_width) < camera.x ||
-                    transform.position.x - (transform.scale.x * label_width) > camera.x + camera.w ||
-                    transform.position.y + (transform.scale.y * label_height) < camera.y ||
-                    transform.position.y - (transform.scale.y * label_height) > camera.y + camera.h
+                    dst_rect.x + dst_rect.w < 0 ||
+                    dst_rect.x > camera.w ||
+                    dst_rect.y + dst_rect.h < 0 ||
+                    dst_rect.y > camera.h
                 );
 
                 if (is_text_outside_camera_view && !text_label.is_fixed) {
                     continue;
                 }
 
-                SDL_Rect dst_rect = {
-                    static_cast<int>(text_label.position.x - (text_label.is_fixed ? 0 : camera.x)),
-                    static_cast<int>(text_label.position.y - (text_label.is_fixed ? 0 : camera.y)),
-                    label_width,
-                    label_height
-                };
-                
+                if (use_glyphs) {
+                    // the label colors leave alpha at 0, text is always drawn opaque
+                    SDL_Color color = {text_label.color.r, text_label.color.g, text_label.color.b, 255};
+                    float pen_x = static_cast<float>(dst_rect.x);
+                    for (char c : text_label.text) {
+                        const Glyph& glyph = glyph_atlas->get_glyph(c);
+                        if (glyph.rect.w > 0) {
+                            SDL_FRect glyph_rect = {pen_x, static_cast<float>(dst_rect.y), static_cast<float>(glyph.rect.w), static_cast<float>(glyph.rect.h)};
+                            glyph_batch.draw(glyph_atlas->get_texture_handle(), glyph.rect, glyph_rect, 0.0, SDL_FLIP_NONE, color, 0);
+                        }
+                        pen_x += glyph.advance;
+                    }
+                    continue;
+                }
+
+                if (font == nullptr) {
+                    font = asset_store->get_font(text_label.asset_id);
+                }
+                SDL_Texture* texture = text_cache.get(renderer, font, text_label.asset_id, text_label.text, text_label.color, label_width, label_height);
+                if (texture == nullptr) {
+                    continue;
+                }
                 SDL_RenderCopy(renderer, texture, NULL, &dst_rect);
-                SDL_DestroyTexture(texture);
             }
+            glyph_batch.flush(renderer);
+        }
+
+        // the cached textures are lost with the renderer's device
+        void clear_cache() {
+            text_cache.clear();
+        }
+
+        const TextCacheStats& get_text_cache_stats() const {
+            return text_cache.get_stats();
         }
 };
 
 #endif
-
@@ -2,10 +2,14 @@
 #define SCRIPT_SYSTEM_H
 
 #include "../ecs/ecs.h"
+#include "../profiler/profile_scope.h"
 #include "../components/script_component.h"
 #include "../components/transform_component.h"
 #include "../components/rigid_body_component.h"
 #include "../logger/logger.h"
+#include "../spatial/spatial_index.h"
+#include "../tilemap/tile_map.h"
+#include "../asset_store/asset_store.h"
 #include <tuple>
 
 // Declare some native C++ functions that we can call from Lua
@@ -21,9 +25,21 @@ std::tuple<double, double> get_entity_position(Entity entity) {
 
 void set_entity_position(Entity entity, double x, double y) {
     if (entity.has_component<TransformComponent>()) {
-        auto& position = entity.get_component<TransformComponent>().position;
-        position.x = x;
-        position.y = y;
+        auto& transform = entity.get_component<TransformComponent>();
+        transform.position.x = x;
+        transform.position.y = y;
+    } else {
+        Logger::Err("Entity does not have a TransformComponent");
+    }
+}
+
+// like set_position, but rendering jumps straight there instead of blending across the move
+void teleport_entity(Entity entity, double x, double y) {
+    if (entity.has_component<TransformComponent>()) {
+        auto& transform = entity.get_component<TransformComponent>();
+        transform.position.x = x;
+        transform.position.y = y;
+        transform.previous_position = transform.position;
     } else {
         Logger::Err("Entity does not have a TransformComponent");
     }
@@ -94,7 +110,7 @@ class ScriptSystem: public System {
             require_component<ScriptComponent>();
         }
 
-        void CreateLuaBinds(sol::state& lua) {
+        void CreateLuaBinds(sol::state& lua, SpatialIndex& spatial_index, const std::unique_ptr<TileMap>& tile_map, const std::unique_ptr<AssetStore>& asset_store) {
             // create the "entity" usertype so Lua knows what an Entity is
             lua.new_usertype<Entity>(
                 "entity",
@@ -108,19 +124,54 @@ class ScriptSystem: public System {
             // bind the native C++ functions to Lua
             lua.set_function("get_position", get_entity_position);
             lua.set_function("set_position", set_entity_position);
+            lua.set_function("teleport", teleport_entity);
             lua.set_function("get_velocity", get_entity_velocity);
             lua.set_function("set_velocity", set_entity_velocity);
             lua.set_function("get_rotation", get_entity_rotation);
             lua.set_function("set_rotation", set_entity_rotation);
             lua.set_function("set_projectile_velocity", set_projectile_velocity);
             lua.set_function("set_animation_frame", set_entity_animation_frame);
+
+            // swap the map's tileset, e.g. set_tileset("tilemap-texture-night"), the cached map chunks redraw on their own
+            TileMap* map = tile_map.get();
+            AssetStore* assets = asset_store.get();
+            lua.set_function("set_tileset", [map, assets](const std::string& asset_id) {
+                int handle = assets->get_texture_handle(asset_id);
+                if (handle >= 0) {
+                    map->set_tileset(handle, map->get_tileset_tile_size(), map->get_tileset_columns());
+                }
+            });
+
+            // spatial queries, the group argument is optional and limits the results to that group
+            SpatialIndex* index = &spatial_index;
+            lua.set_function("query_radius", [index](double x, double y, double radius, sol::optional<std::string> group) {
+                std::vector<Entity> results;
+                index->query_radius(x, y, radius, results, group.value_or(""));
+                return sol::as_table(std::move(results));
+            });
+            lua.set_function("query_aabb", [index](double min_x, double min_y, double max_x, double max_y, sol::optional<std::string> group) {
+                std::vector<Entity> results;
+                index->query_aabb(min_x, min_y, max_x, max_y, results, group.value_or(""));
+                return sol::as_table(std::move(results));
+            });
+            lua.set_function("query_nearest", [index](double x, double y, int k, sol::optional<std::string> group) {
+                std::vector<Entity> results;
+                index->query_nearest_k(x, y, k > 0 ? k : 0, results, group.value_or(""));
+                return sol::as_table(std::move(results));
+            });
+            // returns the first entity hit, or nil
+            lua.set_function("raycast", [index](double x0, double y0, double x1, double y1, double thickness, sol::optional<std::string> group) {
+                return index->raycast(x0, y0, x1, y1, thickness, group.value_or(""));
+            });
             
         }
 
         void Update(double delta_time, int elapsed_time) {
+            PROFILE_SCOPE("ScriptSystem::Update");
             // call the script function for each entity and invoke their lua function
             for (auto entity: get_system_entities()) {
                 const auto script = entity.get_component<ScriptComponent>();
+                PROFILE_SCOPE("Lua on_update_script");
                 script.func(entity, delta_time, elapsed_time); // invoke the lua function
             }
         }
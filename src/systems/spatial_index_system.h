@@ -0,0 +1,59 @@
+#ifndef SPATIAL_INDEX_SYSTEM_H
+#define SPATIAL_INDEX_SYSTEM_H
+
+#include "../ecs/ecs.h"
+#include "../profiler/profile_scope.h"
+#include "../components/transform_component.h"
+#include "../spatial/spatial_index.h"
+#include "../debug/debug_draw.h"
+#include <string>
+
+// Keeps the shared spatial index in sync with entity positions.
+// Runs once at the start of the frame, so every system and script queries the same snapshot.
+class SpatialIndexSystem: public System {
+    private:
+        SpatialIndex index;
+
+    public:
+        SpatialIndexSystem() {
+            require_component<TransformComponent>();
+        }
+
+        void Update() {
+            PROFILE_SCOPE("SpatialIndexSystem::Update");
+            index.clear();
+            for (auto entity: get_system_entities()) {
+                const auto& transform = entity.get_component<TransformComponent>();
+                index.insert(entity, transform.position.x, transform.position.y);
+            }
+            index.build();
+        }
+
+        SpatialIndex& get_index() {
+            return index;
+        }
+
+        // outlines the occupied cells and how many entities each one holds
+        void draw_debug(DebugDraw& debug_draw, const SDL_Rect& camera) {
+            PROFILE_SCOPE("SpatialIndexSystem::draw_debug");
+            const SDL_Color cell_color = {0, 255, 255, 120};
+            float size = index.get_cell_world_size();
+            for (int row = 0; row < index.get_rows(); row++) {
+                for (int column = 0; column < index.get_columns(); column++) {
+                    uint32_t count = index.get_cell_count(column, row);
+                    if (count == 0) {
+                        continue;
+                    }
+                    float x = index.get_origin_x() + column * size - camera.x;
+                    float y = index.get_origin_y() + row * size - camera.y;
+                    if (x + size < 0 || y + size < 0 || x > camera.w || y > camera.h) {
+                        continue;
+                    }
+                    debug_draw.rect({static_cast<int>(x), static_cast<int>(y), static_cast<int>(size), static_cast<int>(size)}, cell_color);
+                    debug_draw.text(x + 3, y + 3, std::to_string(count), cell_color);
+                }
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef STATE_HASH_SYSTEM_H
+#define STATE_HASH_SYSTEM_H
+
+#include <cstdint>
+#include <cstring>
+#include "../ecs/ecs.h"
+#include "../components/transform_component.h"
+#include "../components/rigid_body_component.h"
+#include "../components/health_component.h"
+
+// Fingerprint of the simulation state, compared tick by tick between a recording and its replay.
+// Covers what the simulation decides: which entities exist, where they are, how fast they move and their health.
+// Sprites, audio and fog are left out, they only present that state.
+class StateHashSystem: public System {
+    private:
+        // FNV-1a, 64 bit
+        uint64_t hash = 0;
+
+        void add(const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; i++) {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+        }
+
+        // the bits, not the value, -0.0 and 0.0 differ and a replay has to match either way
+        void add(float value) {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            add(&bits, sizeof(bits));
+        }
+
+    public:
+        StateHashSystem() {
+            require_component<TransformComponent>();
+        }
+
+        uint64_t compute() {
+            hash = 14695981039346656037ull;
+            for (auto entity: get_system_entities()) {
+                int32_t id = entity.get_id();
+                add(&id, sizeof(id));
+                const auto& transform = entity.get_component<TransformComponent>();
+                add(transform.position.x);
+                add(transform.position.y);
+                if (entity.has_component<RigidBodyComponent>()) {
+                    const auto& rigid_body = entity.get_component<RigidBodyComponent>();
+                    add(rigid_body.velocity.x);
+                    add(rigid_body.velocity.y);
+                }
+                if (entity.has_component<HealthComponent>()) {
+                    int32_t health = entity.get_component<HealthComponent>().current_health;
+                    add(&health, sizeof(health));
+                }
+            }
+            return hash;
+        }
+};
+
+#endif
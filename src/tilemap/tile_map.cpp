@@ -0,0 +1,97 @@
+#include "tile_map.h"
+#include <algorithm>
+#include <cmath>
+
+void TileMap::clear() {
+    columns = 0;
+    rows = 0;
+    solid.clear();
+    tile_ids.clear();
+    version++;
+}
+
+void TileMap::load(const std::vector<std::vector<int>>& tile_data, float tile_size, const std::vector<int>& solid_tile_ids) {
+    clear();
+    if (tile_data.empty() || tile_size <= 0) {
+        return;
+    }
+    this->tile_size = tile_size;
+    rows = static_cast<int>(tile_data.size());
+    columns = static_cast<int>(tile_data[0].size());
+    solid.assign(static_cast<size_t>(columns) * rows, 0);
+    tile_ids.assign(static_cast<size_t>(columns) * rows, -1);
+    for (int y = 0; y < rows; y++) {
+        int row_length = std::min(columns, static_cast<int>(tile_data[y].size()));
+        std::copy(tile_data[y].begin(), tile_data[y].begin() + row_length, tile_ids.begin() + static_cast<size_t>(y) * columns);
+    }
+
+    // turn the id list into a lookup table so each tile costs one index, negative ids never match a tile
+    int max_id = -1;
+    for (int id : solid_tile_ids) {
+        max_id = std::max(max_id, id);
+    }
+    if (max_id < 0) {
+        return;
+    }
+    std::vector<uint8_t> is_solid_id(max_id + 1, 0);
+    for (int id : solid_tile_ids) {
+        if (id >= 0) {
+            is_solid_id[id] = 1;
+        }
+    }
+
+    for (int y = 0; y < rows; y++) {
+        // short rows are treated as open ground
+        int row_length = std::min(columns, static_cast<int>(tile_data[y].size()));
+        for (int x = 0; x < row_length; x++) {
+            int id = tile_data[y][x];
+            if (id >= 0 && id <= max_id) {
+                solid[static_cast<size_t>(y) * columns + x] = is_solid_id[id];
+            }
+        }
+    }
+}
+
+void TileMap::set_tileset(int texture_handle, int tile_size, int columns) {
+    tileset_texture_handle = texture_handle;
+    tileset_tile_size = tile_size;
+    tileset_columns = columns;
+    version++;
+}
+
+int TileMap::get_tile(int column, int row) const {
+    if (column < 0 || row < 0 || column >= columns || row >= rows) {
+        return -1;
+    }
+    return tile_ids[static_cast<size_t>(row) * columns + column];
+}
+
+bool TileMap::is_solid(int column, int row) const {
+    if (column < 0 || row < 0 || column >= columns || row >= rows) {
+        return false;
+    }
+    return solid[static_cast<size_t>(row) * columns + column] != 0;
+}
+
+bool TileMap::find_solid(float min_x, float min_y, float max_x, float max_y, int& column, int& row) const {
+    if (solid.empty()) {
+        return false;
+    }
+    // the max edge is exclusive, a box that ends exactly on a tile border doesn't touch the next tile
+    int first_column = std::max(0, static_cast<int>(std::floor(min_x / tile_size)));
+    int first_row = std::max(0, static_cast<int>(std::floor(min_y / tile_size)));
+    int last_column = std::min(columns - 1, static_cast<int>(std::ceil(max_x / tile_size)) - 1);
+    int last_row = std::min(rows - 1, static_cast<int>(std::ceil(max_y / tile_size)) - 1);
+
+    for (int y = first_row; y <= last_row; y++) {
+        const uint8_t* tiles = &solid[static_cast<size_t>(y) * columns];
+        for (int x = first_column; x <= last_column; x++) {
+            if (tiles[x]) {
+                column = x;
+                row = y;
+                return true;
+            }
+        }
+    }
+    return false;
+}
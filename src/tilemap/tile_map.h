@@ -0,0 +1,58 @@
+#ifndef TILE_MAP_H
+#define TILE_MAP_H
+
+#include <cstdint>
+#include <vector>
+
+///////////////////////////
+// Tile Map
+///////////////////////////
+// The level's tile ids in one flat row major array, the tileset they index
+// and one solidity flag per tile, filled in when the level's tilemap is
+// loaded. TileMapRenderer draws it, tiles are not entities. Colliders are
+// tested against the handful of tiles they cover instead of against a
+// collider entity per wall, so blocking terrain costs nothing in the
+// pairwise collision pass no matter how big the map is.
+///////////////////////////
+
+class TileMap {
+    private:
+        int columns = 0;
+        int rows = 0;
+        // world size of one tile, already scaled
+        float tile_size = 1;
+        std::vector<uint8_t> solid;
+        std::vector<int> tile_ids;
+
+        // asset store handle of the tileset texture, tile id N sits at column N % tileset_columns, row N / tileset_columns
+        int tileset_texture_handle = -1;
+        int tileset_tile_size = 0;
+        int tileset_columns = 10;
+        // bumped whenever the tiles or the tileset change, so cached renders of the map know to redraw
+        int version = 0;
+
+    public:
+        TileMap() = default;
+
+        void clear();
+        void load(const std::vector<std::vector<int>>& tile_data, float tile_size, const std::vector<int>& solid_tile_ids);
+
+        // switches the look of the map, e.g. day and night tilesets with the same layout
+        void set_tileset(int texture_handle, int tile_size, int columns = 10);
+        int get_tileset_texture_handle() const { return tileset_texture_handle; }
+        int get_tileset_tile_size() const { return tileset_tile_size; }
+        int get_tileset_columns() const { return tileset_columns; }
+        int get_version() const { return version; }
+
+        // -1 outside the map
+        int get_tile(int column, int row) const;
+        bool is_solid(int column, int row) const;
+        // finds the first solid tile under the box, scanning row by row
+        bool find_solid(float min_x, float min_y, float max_x, float max_y, int& column, int& row) const;
+
+        int get_columns() const { return columns; }
+        int get_rows() const { return rows; }
+        float get_tile_size() const { return tile_size; }
+};
+
+#endif
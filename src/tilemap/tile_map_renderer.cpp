@@ -0,0 +1,112 @@
+#include "tile_map_renderer.h"
+#include "../asset_store/asset_store.h"
+#include "../logger/logger.h"
+#include "../profiler/profile_scope.h"
+#include <algorithm>
+#include <cmath>
+
+TileMapRenderer::~TileMapRenderer() {
+    invalidate();
+}
+
+void TileMapRenderer::invalidate() {
+    for (auto chunk : chunks) {
+        if (chunk) {
+            SDL_DestroyTexture(chunk);
+        }
+    }
+    chunks.clear();
+    chunk_columns = 0;
+    chunk_rows = 0;
+    cached_version = -1;
+}
+
+int TileMapRenderer::get_cached_chunk_count() const {
+    return static_cast<int>(std::count_if(chunks.begin(), chunks.end(), [](SDL_Texture* chunk) { return chunk != nullptr; }));
+}
+
+SDL_Texture* TileMapRenderer::build_chunk(SDL_Renderer* renderer, const TileMap& tile_map, const AssetStore& asset_store, int chunk_x, int chunk_y) {
+    const TextureRegion* tileset = asset_store.get_texture_region(tile_map.get_tileset_texture_handle());
+    int tile_size = tile_map.get_tileset_tile_size();
+    if (!tileset || tile_size <= 0) {
+        return nullptr;
+    }
+
+    int chunk_size = CHUNK_TILES * tile_size;
+    SDL_Texture* chunk = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, chunk_size, chunk_size);
+    if (!chunk) {
+        Logger::Err("Failed to create tilemap chunk texture: " + std::string(SDL_GetError()));
+        return nullptr;
+    }
+    SDL_SetTextureBlendMode(chunk, SDL_BLENDMODE_BLEND);
+
+    SDL_Texture* previous_target = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, chunk);
+    // chunks past the map edge stay see-through
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    SDL_Texture* page = asset_store.get_atlas_page(tileset->page);
+    int first_column = chunk_x * CHUNK_TILES;
+    int first_row = chunk_y * CHUNK_TILES;
+    for (int y = 0; y < CHUNK_TILES; y++) {
+        for (int x = 0; x < CHUNK_TILES; x++) {
+            int tile_id = tile_map.get_tile(first_column + x, first_row + y);
+            if (tile_id < 0) {
+                continue;
+            }
+            SDL_Rect src_rect = {
+                tileset->rect.x + (tile_id % tile_map.get_tileset_columns()) * tile_size,
+                tileset->rect.y + (tile_id / tile_map.get_tileset_columns()) * tile_size,
+                tile_size,
+                tile_size
+            };
+            SDL_Rect dst_rect = {x * tile_size, y * tile_size, tile_size, tile_size};
+            SDL_RenderCopy(renderer, page, &src_rect, &dst_rect);
+        }
+    }
+
+    SDL_SetRenderTarget(renderer, previous_target);
+    return chunk;
+}
+
+void TileMapRenderer::Render(SDL_Renderer* renderer, const TileMap& tile_map, const AssetStore& asset_store, const SDL_Rect& camera) {
+    PROFILE_SCOPE("TileMapRenderer::Render");
+    if (tile_map.get_columns() == 0 || tile_map.get_tileset_tile_size() <= 0) {
+        return;
+    }
+
+    if (cached_version != tile_map.get_version()) {
+        invalidate();
+        cached_version = tile_map.get_version();
+        chunk_columns = (tile_map.get_columns() + CHUNK_TILES - 1) / CHUNK_TILES;
+        chunk_rows = (tile_map.get_rows() + CHUNK_TILES - 1) / CHUNK_TILES;
+        chunks.assign(static_cast<size_t>(chunk_columns) * chunk_rows, nullptr);
+    }
+
+    // world size of a chunk, the chunk texture itself is at tileset resolution and gets scaled up when drawn
+    float chunk_world_size = CHUNK_TILES * tile_map.get_tile_size();
+    int first_x = std::max(0, static_cast<int>(std::floor(camera.x / chunk_world_size)));
+    int first_y = std::max(0, static_cast<int>(std::floor(camera.y / chunk_world_size)));
+    int last_x = std::min(chunk_columns - 1, static_cast<int>(std::floor((camera.x + camera.w) / chunk_world_size)));
+    int last_y = std::min(chunk_rows - 1, static_cast<int>(std::floor((camera.y + camera.h) / chunk_world_size)));
+
+    for (int chunk_y = first_y; chunk_y <= last_y; chunk_y++) {
+        for (int chunk_x = first_x; chunk_x <= last_x; chunk_x++) {
+            SDL_Texture*& chunk = chunks[static_cast<size_t>(chunk_y) * chunk_columns + chunk_x];
+            if (!chunk) {
+                chunk = build_chunk(renderer, tile_map, asset_store, chunk_x, chunk_y);
+                if (!chunk) {
+                    continue;
+                }
+            }
+            // snap both edges to whole pixels so neighbouring chunks meet without a seam
+            int left = static_cast<int>(chunk_x * chunk_world_size) - camera.x;
+            int top = static_cast<int>(chunk_y * chunk_world_size) - camera.y;
+            int right = static_cast<int>((chunk_x + 1) * chunk_world_size) - camera.x;
+            int bottom = static_cast<int>((chunk_y + 1) * chunk_world_size) - camera.y;
+            SDL_Rect dst_rect = {left, top, right - left, bottom - top};
+            SDL_RenderCopy(renderer, chunk, NULL, &dst_rect);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef TILE_MAP_RENDERER_H
+#define TILE_MAP_RENDERER_H
+
+#include <vector>
+#include <SDL2/SDL.h>
+#include "tile_map.h"
+
+class AssetStore;
+
+///////////////////////////
+// Tile Map Renderer
+///////////////////////////
+// Draws the TileMap as square chunks of CHUNK_TILES x CHUNK_TILES tiles.
+// Each chunk is rendered once into a render target texture at tileset
+// resolution and then drawn with a single copy, only for the chunks the
+// camera can see. The cache is thrown away when the map's version changes
+// (new level, tileset switch) or when the renderer loses its targets.
+///////////////////////////
+
+class TileMapRenderer {
+    private:
+        static const int CHUNK_TILES = 16;
+
+        // row major, null until the chunk is first seen
+        std::vector<SDL_Texture*> chunks;
+        int chunk_columns = 0;
+        int chunk_rows = 0;
+        int cached_version = -1;
+
+        SDL_Texture* build_chunk(SDL_Renderer* renderer, const TileMap& tile_map, const AssetStore& asset_store, int chunk_x, int chunk_y);
+
+    public:
+        TileMapRenderer() = default;
+        ~TileMapRenderer();
+
+        // drops every cached chunk, they are rebuilt as they come into view
+        void invalidate();
+        void Render(SDL_Renderer* renderer, const TileMap& tile_map, const AssetStore& asset_store, const SDL_Rect& camera);
+
+        int get_cached_chunk_count() const;
+};
+
+#endif
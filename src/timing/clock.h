@@ -0,0 +1,45 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <SDL2/SDL.h>
+
+///////////////////////////
+// Clock
+///////////////////////////
+// The milliseconds the simulation sees. It is SDL_GetTicks() by default.
+// When runs have to be reproducible (input recording and replay) it is
+// switched to simulated time, which only moves when the game advances it
+// by one fixed step per Update(). Animation frames, emission intervals and
+// projectile lifetimes then depend on the tick count, not on how fast the
+// machine ran the frames.
+// Audio, the radar and the GUI only present the simulation and stay on
+// SDL_GetTicks().
+///////////////////////////
+
+class Clock {
+    private:
+        inline static bool is_simulated = false;
+        // kept fractional, a 60 Hz step is not a whole number of milliseconds
+        inline static double simulated_ms = 0;
+
+    public:
+        static Uint32 get_ticks() {
+            return is_simulated ? static_cast<Uint32>(simulated_ms) : SDL_GetTicks();
+        }
+
+        // from here on get_ticks() only moves with advance()
+        static void use_simulated_time(Uint32 start_ms = 0) {
+            is_simulated = true;
+            simulated_ms = start_ms;
+        }
+
+        static void advance(double seconds) {
+            if (is_simulated) {
+                simulated_ms += seconds * 1000.0;
+            }
+        }
+
+        static bool get_is_simulated() { return is_simulated; }
+};
+
+#endif
@@ -0,0 +1,101 @@
+#include "frame_pacer.h"
+#include "../profiler/profile_scope.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+FramePacer::FramePacer() {
+    frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+    frame_times_ms.reserve(HISTORY_SIZE);
+    reset();
+}
+
+void FramePacer::set_target_fps(double fps) {
+    period = fps > 0 ? static_cast<uint64_t>(frequency / fps) : 0;
+    stats.target_ms = fps > 0 ? 1000.0 / fps : 0;
+    next_deadline = SDL_GetPerformanceCounter() + period;
+}
+
+void FramePacer::reset() {
+    previous_frame = SDL_GetPerformanceCounter();
+    next_deadline = previous_frame + period;
+}
+
+void FramePacer::sleep_until(uint64_t deadline) {
+    uint64_t spin_ticks = static_cast<uint64_t>(SPIN_THRESHOLD_SECONDS * frequency);
+    uint64_t now = SDL_GetPerformanceCounter();
+    // coarse sleep for everything but the last stretch
+    if (deadline > now + spin_ticks) {
+        double sleep_seconds = (deadline - now - spin_ticks) / frequency;
+#if defined(__linux__)
+        timespec duration;
+        duration.tv_sec = static_cast<time_t>(sleep_seconds);
+        duration.tv_nsec = static_cast<long>((sleep_seconds - duration.tv_sec) * 1e9);
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &duration, nullptr);
+#else
+        SDL_Delay(static_cast<Uint32>(sleep_seconds * 1000.0));
+#endif
+    }
+    // then give the core away a moment at a time until the deadline
+    while (SDL_GetPerformanceCounter() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+double FramePacer::wait() {
+    PROFILE_SCOPE("FramePacer::wait");
+    if (period > 0) {
+        sleep_until(next_deadline);
+        next_deadline += period;
+        // a frame that ran more than a whole period over starts a fresh schedule instead of
+        // rushing the next frames to make up for it
+        uint64_t now = SDL_GetPerformanceCounter();
+        if (now > next_deadline) {
+            next_deadline = now + period;
+        }
+    }
+
+    uint64_t now = SDL_GetPerformanceCounter();
+    double frame_seconds = (now - previous_frame) / frequency;
+    previous_frame = now;
+
+    if (frame_times_ms.size() < HISTORY_SIZE) {
+        frame_times_ms.push_back(frame_seconds * 1000.0);
+    } else {
+        frame_times_ms[history_cursor] = frame_seconds * 1000.0;
+    }
+    history_cursor = (history_cursor + 1) % HISTORY_SIZE;
+    return frame_seconds;
+}
+
+const FrameStats& FramePacer::get_stats() {
+    if (frame_times_ms.empty()) {
+        return stats;
+    }
+    sorted_scratch.assign(frame_times_ms.begin(), frame_times_ms.end());
+    std::sort(sorted_scratch.begin(), sorted_scratch.end());
+    stats.min_ms = sorted_scratch.front();
+    stats.max_ms = sorted_scratch.back();
+    size_t p99_index = std::min(static_cast<size_t>(std::ceil(sorted_scratch.size() * 0.99)) - 1, sorted_scratch.size() - 1);
+    stats.p99_ms = sorted_scratch[p99_index];
+    double total = 0;
+    for (double frame_time : sorted_scratch) {
+        total += frame_time;
+    }
+    stats.average_ms = total / sorted_scratch.size();
+
+    // jitter is the distance from the frame time the pacer aims for, uncapped frames have no target
+    // so they are measured against their average
+    double reference_ms = stats.target_ms > 0 ? stats.target_ms : stats.average_ms;
+    for (double& frame_time : sorted_scratch) {
+        frame_time = std::fabs(frame_time - reference_ms);
+    }
+    std::sort(sorted_scratch.begin(), sorted_scratch.end());
+    stats.jitter_min_ms = sorted_scratch.front();
+    stats.jitter_max_ms = sorted_scratch.back();
+    stats.jitter_p99_ms = sorted_scratch[p99_index];
+    return stats;
+}
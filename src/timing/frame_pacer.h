@@ -0,0 +1,68 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <cstdint>
+#include <vector>
+#include <SDL2/SDL.h>
+
+// achieved frame times over the last FramePacer::HISTORY_SIZE frames, in milliseconds
+struct FrameStats {
+    double target_ms = 0;
+    double average_ms = 0;
+    double min_ms = 0;
+    double max_ms = 0;
+    double p99_ms = 0;
+    // how far frames land from target_ms (from the average when uncapped), |frame time - target|
+    double jitter_min_ms = 0;
+    double jitter_max_ms = 0;
+    double jitter_p99_ms = 0;
+};
+
+///////////////////////////
+// Frame Pacer
+///////////////////////////
+// Holds frames to a target rate using the performance counter. Frames are
+// paced against absolute deadlines, so an early or late frame doesn't shift
+// every frame after it. Waiting is hybrid: the OS sleep is only trusted up
+// to SPIN_THRESHOLD before the deadline, because it oversleeps by a
+// millisecond or two. The rest is spent yielding in a loop, which lands
+// within microseconds.
+// Every frame time is kept in a ring buffer for the debug panel's jitter
+// stats.
+///////////////////////////
+
+class FramePacer {
+    private:
+        double frequency;
+        // performance counter ticks per frame, 0 when uncapped
+        uint64_t period = 0;
+        uint64_t next_deadline = 0;
+        uint64_t previous_frame = 0;
+
+        static const size_t HISTORY_SIZE = 240;
+        std::vector<double> frame_times_ms;
+        size_t history_cursor = 0;
+        std::vector<double> sorted_scratch;
+        FrameStats stats;
+
+        // sleep is only trusted up to this close to the deadline
+        static constexpr double SPIN_THRESHOLD_SECONDS = 0.002;
+
+        void sleep_until(uint64_t deadline);
+
+    public:
+        FramePacer();
+
+        // 0 or less runs uncapped
+        void set_target_fps(double fps);
+        // call once when the loop starts, so the first frame isn't measured from construction
+        void reset();
+
+        // blocks until the next frame is due and returns the real seconds since the previous one
+        double wait();
+
+        // frame time and jitter min, max and p99 over the recorded window, computed on call
+        const FrameStats& get_stats();
+};
+
+#endif